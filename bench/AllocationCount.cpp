@@ -0,0 +1,123 @@
+// Counts heap allocations and times a few workloads run through batch files.
+// Built and run by "make bench"; writes its inputs into bin/.
+#include "Simulation.h"
+#include "SnapshotStore.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+using namespace std;
+
+Simulation* backup = nullptr;
+SnapshotStore snapshots;
+
+namespace {
+    unsigned long long allocations = 0;
+
+    const int SETTLEMENTS = 100;
+    const int FACILITIES = 30;
+    const int PLANS = 2000;
+    const int ADDED_PLANS = 300000;
+    const char *POLICIES[] = {"nve", "bal", "eco", "env"};
+
+    // Same inputs on every run
+    unsigned int seed = 12345;
+    int next(int bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % bound;
+    }
+
+    void writeConfig(const string &path) {
+        ofstream out(path);
+        for (int i = 0; i < SETTLEMENTS; i++) {
+            out << "settlement s" << i << " " << next(3) << "\n";
+        }
+        for (int i = 0; i < FACILITIES; i++) {
+            out << "facility f" << i << " " << next(3) << " " << 1 + next(5) << " "
+                << next(6) << " " << next(6) << " " << next(6) << "\n";
+        }
+        for (int i = 0; i < PLANS; i++) {
+            out << "plan s" << next(SETTLEMENTS) << " " << POLICIES[next(4)] << "\n";
+        }
+    }
+
+    void writeSteps(const string &path) {
+        ofstream out(path);
+        for (int i = 0; i < 500; i++) {
+            out << "step 1\n";
+        }
+    }
+
+    void writeBackups(const string &path) {
+        ofstream out(path);
+        for (int i = 0; i < 10; i++) {
+            for (int j = 0; j < 5; j++) {
+                out << "step 20\nbackup\n";
+            }
+            out << "restore\n";
+        }
+    }
+
+    void writePlans(const string &path) {
+        ofstream out(path);
+        for (int i = 0; i < ADDED_PLANS; i++) {
+            out << "plan s" << next(SETTLEMENTS) << " " << POLICIES[next(4)] << "\n";
+        }
+    }
+
+    // Runs a batch file on a fresh simulation, with its output discarded
+    void run(const string &config, const string &name, const string &batch) {
+        Simulation simulation(config);
+        streambuf *shown = cout.rdbuf(nullptr);
+        unsigned long long before = allocations;
+        auto start = chrono::steady_clock::now();
+        simulation.startBatch(batch);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        unsigned long long counted = allocations - before;
+        cout.rdbuf(shown);
+        cout << name << ": " << counted << " allocations, " << static_cast<long long>(ms) << " ms" << endl;
+        if (backup != nullptr) {
+            delete backup;
+            backup = nullptr;
+        }
+    }
+}
+
+void *operator new(size_t size) {
+    allocations++;
+    void *block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr) {
+        throw bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void *block) noexcept {
+    free(block);
+}
+
+void operator delete(void *block, size_t) noexcept {
+    free(block);
+}
+
+int main(int argc, char** argv){
+    string directory = argc > 1 ? argv[1] : "bin";
+    string config = directory + "/bench_config.txt";
+    writeConfig(config);
+    writeSteps(directory + "/bench_steps.txt");
+    writeBackups(directory + "/bench_backups.txt");
+    writePlans(directory + "/bench_plans.txt");
+    try {
+        run(config, "500 steps", directory + "/bench_steps.txt");
+        run(config, "50 steps and backups, 10 restores", directory + "/bench_backups.txt");
+        run(config, "300000 added plans", directory + "/bench_plans.txt");
+    } catch (const exception &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
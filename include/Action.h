@@ -5,16 +5,14 @@
 enum class SettlementType;
 enum class FacilityCategory;
 
-enum class ActionStatus{
-    COMPLETED, ERROR
-};
-
 class BaseAction{
     public:
         BaseAction();
         ActionStatus getStatus() const;
         virtual void act(Simulation& simulation)=0;
         virtual const string toString() const=0;
+        // What the actions log keeps of the action, with strings interned in the log
+        virtual ActionRecord toRecord() const=0;
         virtual BaseAction* clone() const = 0;
         virtual ~BaseAction() = default;
 
@@ -34,6 +32,7 @@ class SimulateStep : public BaseAction {
         SimulateStep(const int numOfSteps);
         void act(Simulation &simulation) override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
         SimulateStep *clone() const override;
     private:
         const int numOfSteps;
@@ -44,6 +43,7 @@ class AddPlan : public BaseAction {
         AddPlan(const string &settlementName, const string &selectionPolicy);
         void act(Simulation &simulation) override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
         AddPlan *clone() const override;
     private:
         const string settlementName;
@@ -57,6 +57,7 @@ class AddSettlement : public BaseAction {
         void act(Simulation &simulation) override;
         AddSettlement *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const string settlementName;
         const SettlementType settlementType;
@@ -70,6 +71,7 @@ class AddFacility : public BaseAction {
         void act(Simulation &simulation) override;
         AddFacility *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const string facilityName;
         const FacilityCategory facilityCategory;
@@ -86,6 +88,7 @@ class PrintPlanStatus: public BaseAction {
         void act(Simulation &simulation) override;
         PrintPlanStatus *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const int planId;
 };
@@ -97,6 +100,7 @@ class ChangePlanPolicy : public BaseAction {
         void act(Simulation &simulation) override;
         ChangePlanPolicy *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
         const int planId;
         const string newPolicy;
@@ -107,10 +111,45 @@ class ChangePlanPolicy : public BaseAction {
 class PrintActionsLog : public BaseAction {
     public:
         PrintActionsLog();
+        PrintActionsLog(size_t from, size_t to); // Only entries [from, to)
+        static PrintActionsLog tail(size_t count); // Only the last count entries
         void act(Simulation &simulation) override;
         PrintActionsLog *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        PrintActionsLog(size_t from, size_t to, bool fromEnd);
+        // The words the log command was given, empty for a bare "log"
+        string firstWord() const;
+
+        const size_t from;
+        const size_t to; // The entry count for a tail
+        const bool fromEnd; // A tail
+};
+
+// Prints the best plans by a metric, as close prints them
+class PrintLeaderboard : public BaseAction {
+    public:
+        PrintLeaderboard(int count, Leaderboard::Metric metric);
+        void act(Simulation &simulation) override;
+        PrintLeaderboard *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const int count;
+        const Leaderboard::Metric metric;
+};
+
+// Prints the totals of one settlement's plans, or of all plans
+class PrintStats : public BaseAction {
+    public:
+        PrintStats(const string &settlementName); // Empty for all plans
+        void act(Simulation &simulation) override;
+        PrintStats *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
+        const string settlementName;
 };
 
 class Close : public BaseAction {
@@ -119,24 +158,55 @@ class Close : public BaseAction {
         void act(Simulation &simulation) override;
         Close *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
 };
 
 class BackupSimulation : public BaseAction {
     public:
         BackupSimulation();
+        BackupSimulation(const string &name);
         void act(Simulation &simulation) override;
         BackupSimulation *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
+        const string name; // Empty for the unnamed backup
 };
 
 
 class RestoreSimulation : public BaseAction {
     public:
         RestoreSimulation();
+        RestoreSimulation(const string &name);
         void act(Simulation &simulation) override;
         RestoreSimulation *clone() const override;
         const string toString() const override;
+        ActionRecord toRecord() const override;
     private:
-};
\ No newline at end of file
+        const string name; // Empty for the unnamed backup
+};
+
+
+class SaveCheckpoint : public BaseAction {
+    public:
+        SaveCheckpoint(const string &path);
+        void act(Simulation &simulation) override;
+        SaveCheckpoint *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string path;
+};
+
+
+class LoadCheckpoint : public BaseAction {
+    public:
+        LoadCheckpoint(const string &path);
+        void act(Simulation &simulation) override;
+        LoadCheckpoint *clone() const override;
+        const string toString() const override;
+        ActionRecord toRecord() const override;
+    private:
+        const string path;
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "NameTable.h"
+#include "SharedChunkList.h"
+using std::string;
+using std::vector;
+
+enum class ActionStatus : uint8_t {
+    COMPLETED, ERROR
+};
+
+enum class ActionKind : uint8_t {
+    STEP, ADD_PLAN, ADD_SETTLEMENT, ADD_FACILITY, PLAN_STATUS, CHANGE_POLICY,
+    PRINT_LOG, CLOSE, BACKUP, RESTORE, SAVE, LOAD, TOP, STATS, KIND_COUNT
+};
+
+// One logged action: what the log prints about it, with strings as symbols of
+// the NameTable. Plain data, so records can be copied and written out as bytes.
+struct ActionRecord {
+    ActionKind kind;
+    ActionStatus status;
+    uint16_t padding;
+    int32_t value;    // Steps, plan ID or settlement type
+    Symbol text[2];   // Names, policies or paths, NameTable::NONE when unused
+};
+static_assert(sizeof(ActionRecord) == 16, "ActionRecord is written to checkpoints as bytes");
+
+// The actions log. Records are appended in place into large chunks, and
+// copies of the log, like a backup's, share every chunk but a partly filled
+// last one.
+//
+// A log can be bounded: once it holds a chunk more than its capacity, its
+// oldest chunk moves to an append-only file of raw records. Each copy keeps
+// the file ranges (extents) that hold its own older records. Records already
+// in the file never change, so after a restore the live log and its backups
+// point at different extents of the same file.
+class ActionLog {
+    public:
+        static const size_t CHUNK_SIZE = 4096;
+
+        ActionLog();
+        // Keeps the newest capacity records (up to a chunk more) in memory
+        // and moves older ones to the file at path, which is truncated
+        void spillTo(const string &path, size_t capacity);
+        // Spills to the same file, at the same capacity, as other
+        void spillLike(const ActionLog &other);
+        size_t size() const; // Every record, in memory or spilled
+        bool empty() const;
+        void append(const ActionRecord &record);
+        void clear();
+
+        // Prints records [from, to) as "<description> COMPLETED|ERROR"
+        void print(std::ostream &out, size_t from, size_t to) const;
+        void describe(const ActionRecord &record, string &out) const;
+        // The description of an action, shared with the actions' toString()
+        static void describe(ActionKind kind, int value, const string &first, const string &second, string &out);
+
+        // Hands records [from, to) to visitor in order, a contiguous block at a time
+        void visit(size_t from, size_t to, const std::function<void(const ActionRecord *records, size_t count)> &visitor) const;
+
+    private:
+        // The file spilled records go to, shared by every copy of a log
+        class SpillFile {
+            public:
+                SpillFile(const string &path);
+                ~SpillFile();
+                SpillFile(const SpillFile &other) = delete;
+                SpillFile &operator=(const SpillFile &other) = delete;
+                // Appends records and returns the index of the first
+                uint64_t write(const ActionRecord *records, size_t count);
+                void read(uint64_t first, size_t count, ActionRecord *records) const;
+
+            private:
+                string path;
+                int fd;
+                uint64_t written;
+        };
+
+        struct Extent {
+            uint64_t first; // Index of the first record in the file
+            uint64_t count;
+        };
+
+        void spillOldestChunk();
+
+        SharedChunkList<ActionRecord, CHUNK_SIZE> records; // The newest records
+        std::shared_ptr<vector<Extent>> extents; // Older records, oldest first
+        size_t spilled;
+        size_t capacity;
+        std::shared_ptr<SpillFile> file; // None for a log kept whole in memory
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+using std::vector;
+
+class FacilityCatalog;
+
+// A 2D tree over the facility types of a catalog, answering BalancedSelection's
+// query without looking at every type.
+//
+// With x = lifeQuality - environment and y = lifeQuality - economy, a type's
+// three score gaps for a plan are |x + a|, |y + b| and |(y + b) - (x + a)|,
+// where a and b are the same differences of the plan's own scores. The best
+// type is then the point nearest to (-a, -b) under max(|dx|, |dy|, |dy - dx|).
+// Subtrees are skipped when a bound on that distance over their bounding box
+// can't beat the best type so far, counting a tie as beaten only by a lower
+// index, so the answer is the one the linear scan gives.
+class BalancedIndex {
+    public:
+        BalancedIndex(const FacilityCatalog &catalog);
+        // Same result as BalancedScan::findBest on the catalog the index was built from
+        size_t findBest(int lifeQuality, int economy, int environment) const;
+
+        // Smaller catalogs are scanned rather than indexed
+        static const size_t MIN_CATALOG_SIZE = 256;
+
+    private:
+        struct Point {
+            long long x;
+            long long y;
+            size_t index;
+        };
+
+        struct Node {
+            long long minX, maxX, minY, maxY;
+            size_t minIndex; // Lowest catalog index in the subtree
+            size_t begin, end; // The subtree's points
+            int left, right; // Children, -1 for a leaf
+        };
+
+        int build(size_t begin, size_t end);
+        long long lowerBound(const Node &node, long long a, long long b) const;
+
+        static const size_t LEAF_SIZE = 8;
+
+        vector<Point> points;
+        vector<Node> nodes;
+};
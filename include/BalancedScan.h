@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include "FacilityCatalog.h"
+
+// Finds the facility type BalancedSelection builds next: the first one that,
+// added to a plan's scores, leaves the smallest largest gap between any two
+// of the three scores. Scans the catalog's score arrays with AVX2 or SSE4.1
+// when the CPU has them, and one type at a time otherwise.
+class BalancedScan {
+    public:
+        enum Kernel { SCALAR, SSE41, AVX2 };
+
+        // The index of the type, or SIZE_MAX if every gap is INT_MAX or more
+        static size_t findBest(const FacilityCatalog &catalog, int lifeQuality, int economy, int environment);
+        static size_t findBest(const FacilityCatalog &catalog, int lifeQuality, int economy, int environment, Kernel kernel);
+        // The fastest kernel this CPU runs
+        static Kernel bestKernel();
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include "Simulation.h"
+using std::string;
+
+// Binary on-disk checkpoints of a whole simulation: settlements, facility
+// types, plans with their policy state and facilities, and the actions log.
+//
+// The file is a header followed by 8-byte aligned sections of fixed-size
+// records, with every string stored once in a string section and referenced
+// by offset. Loading maps the file and walks the record arrays in place, so
+// nothing is tokenized or parsed. Numbers are stored in the machine's own byte
+// order; a checkpoint is meant to be loaded on the machine that wrote it.
+class Checkpoint {
+    public:
+        static void save(const Simulation &simulation, const string &path);
+        static void load(Simulation &simulation, const string &path);
+
+        static const unsigned int FORMAT_VERSION = 3;
+};
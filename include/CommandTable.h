@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+class Simulation;
+
+// The arguments of a command line, already converted to the kinds the
+// command declared. Missing arguments read as empty words and invalid
+// integers.
+class CommandArgs {
+    public:
+        CommandArgs();
+        const string &word(size_t i) const;
+        bool isInt(size_t i) const; // Present and starting with a number in range
+        int integer(size_t i) const; // 0 unless isInt
+        // Reads a word the way integer arguments are read
+        static bool toInt(const string &text, int &value);
+
+    private:
+        friend class CommandTable;
+        vector<string> words;
+        vector<int> integers;
+        vector<bool> valid;
+};
+
+typedef std::function<void(Simulation &simulation, const CommandArgs &args)> CommandHandler;
+
+// Commands by name. Names are found through a perfect hash: the table's seed
+// is chosen whenever a command is added so that no two names share a slot,
+// and a lookup hashes the line's first word once and compares one name.
+// Each command's argument list is converted before its handler runs, by a
+// parser built from the argument spec when the command is added.
+class CommandTable {
+    public:
+        CommandTable();
+        // spec has a letter per argument: 'w' for a word, 'i' for an integer.
+        // Adding a name again replaces the command.
+        void add(const string &name, const string &spec, const CommandHandler &handler);
+        bool contains(const string &name) const;
+        // Runs the command a line starts with. Returns false, with the line's
+        // first word in command, when no such command exists.
+        bool dispatch(Simulation &simulation, const string &line, string &command);
+
+    private:
+        enum ArgumentKind { WORD, INTEGER };
+        struct Command {
+            string name;
+            vector<ArgumentKind> arguments;
+            CommandHandler handler;
+        };
+
+        int find(const char *begin, const char *end) const;
+        size_t slotOf(const char *begin, const char *end) const;
+        void rebuild();
+
+        vector<Command> commands;
+        vector<int> slots; // Command index per hash slot, -1 when empty
+        unsigned int seed;
+        CommandArgs args; // Reused by every dispatch
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ConfigParser.h"
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+// Loads a config file held in memory into an empty simulation, on several
+// threads for large files.
+//
+// The file is cut into line-aligned chunks. Each chunk is tokenized on its
+// own thread into records, then every plan's settlement is looked up on the
+// chunk's thread too, once all settlements are known. A plan may only name a
+// settlement defined on an earlier line, which the lookup checks by comparing
+// file positions, so references across chunks need no coordination. Last,
+// records are added to the simulation in file order, which hands out plan
+// IDs exactly like a line by line load. The first error in file order is the
+// one reported.
+class ConfigLoader {
+    public:
+        static void load(Simulation &simulation, const char *data, size_t size, int threadCount);
+
+        // Smallest chunk worth a thread of its own
+        static const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    private:
+        struct Record {
+            enum Kind { SETTLEMENT, FACILITY, PLAN };
+            Kind kind;
+            ConfigToken name; // The settlement or facility, or the plan's settlement
+            ConfigToken policy;
+            int values[6]; // The settlement type, or the facility's category and scores
+            size_t line;
+            size_t settlement; // A plan's settlement, once looked up
+        };
+
+        struct Chunk {
+            Chunk() : begin(nullptr), end(nullptr), lineCount(0), firstLine(1), position(0), records(), failed(false), error() {}
+            // The pointers are into the file, which chunks never own
+            Chunk(const Chunk &other) = default;
+            Chunk(Chunk &&other) = default;
+            Chunk &operator=(const Chunk &other) = default;
+            Chunk &operator=(Chunk &&other) = default;
+
+            const char *begin;
+            const char *end;
+            size_t lineCount; // Newlines in the chunk
+            size_t firstLine;
+            size_t position; // Records in earlier chunks
+            vector<Record> records;
+            bool failed; // Loading must stop after the chunk's records
+            string error;
+        };
+
+        static void parse(Chunk &chunk);
+        static void resolvePlans(Chunk &chunk, const Simulation &simulation, const vector<size_t> &definedAt);
+        static void runParallel(vector<Chunk> &chunks, const std::function<void(Chunk &)> &work);
+        static string errorAt(const Record &record, const string &message);
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+using std::string;
+
+// A word of the config file, pointing into the parser's buffer
+struct ConfigToken {
+    const char *begin;
+    const char *end;
+    size_t column; // 1-based
+
+    bool equals(const char *word) const;
+    string str() const;
+};
+
+// Splits a config file held in memory into lines and whitespace separated
+// tokens without copying it. Empty lines and lines starting with '#' are
+// skipped. Errors name the line and column they were found at.
+class ConfigParser {
+    public:
+        // firstLineNumber numbers the first line, for parsers that start
+        // part way into a file
+        ConfigParser(const char *data, size_t size, size_t firstLineNumber = 1);
+
+        // Moves to the next line that holds anything; false at the end of the file
+        bool nextLine();
+        // Next token of the current line; false at the end of the line
+        bool nextToken(ConfigToken &token);
+        // Like nextToken, but a missing token is an error
+        ConfigToken expectToken(const char *what);
+        // Reads an integer the way std::stoi does: an optional sign and
+        // leading digits, ignoring whatever follows them
+        int expectInt(const char *what);
+        size_t getLineNumber() const;
+        [[noreturn]] void fail(size_t column, const string &message) const;
+
+    private:
+        const char *end;
+        const char *nextLineBegin;
+        const char *lineBegin;
+        const char *lineEnd;
+        const char *position; // Inside the current line
+        size_t lineNumber;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "NameTable.h"
 using std::string;
 using std::vector;
 
@@ -24,6 +25,7 @@ public:
     FacilityType(const string &name, const FacilityCategory category, const int price, 
     const int lifeQuality_score, const int economy_score, const int environment_score);
     const string &getName() const;
+    Symbol getNameSymbol() const;
     int getCost() const;
     int getLifeQualityScore() const;
     int getEnvironmentScore() const;
@@ -31,7 +33,7 @@ public:
     FacilityCategory getCategory() const;
 
 protected:
-    const string name;
+    const Symbol name;
     const FacilityCategory category;
     const int price;
     const int lifeQuality_score;
@@ -48,6 +50,7 @@ public:
     Facility(const FacilityType &type, const string &settlementName);
 
     const string &getSettlementName() const;
+    Symbol getSettlementSymbol() const;
     const int getTimeLeft() const;
     FacilityStatus step();
     void setStatus(FacilityStatus status);
@@ -55,7 +58,7 @@ public:
     const string toString() const;
 
 private:
-    const string settlementName;
+    const Symbol settlementName;
     FacilityStatus status;
     int timeLeft;
 };
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "BalancedIndex.h"
+#include "Facility.h"
+#include "WeightedOrder.h"
+using std::vector;
+
+// The facility types a simulation can build, in the order they were added.
+// Next to the types it keeps each score in an array of its own, so policies
+// that scan the whole catalog read contiguous ints rather than objects.
+// Large catalogs also get a BalancedIndex, built by prepare() and dropped
+// whenever a type is added; copies share it. The indices of each category's
+// types are kept in order as well, for the policies that pick by category.
+// Once prepared, the catalog also keeps the WeightedOrder for each set of
+// weights asked for, until a type is added.
+class FacilityCatalog {
+    public:
+        typedef vector<FacilityType>::const_iterator const_iterator;
+
+        FacilityCatalog();
+        FacilityCatalog(const FacilityCatalog &other) = default;
+        // Moves leave other empty, with a version of its own
+        FacilityCatalog(FacilityCatalog &&other);
+        // FacilityType can't be assigned, so the types are copied one by one
+        FacilityCatalog &operator=(const FacilityCatalog &other);
+        FacilityCatalog &operator=(FacilityCatalog &&other);
+
+        size_t size() const;
+        bool empty() const;
+        const FacilityType &operator[](size_t i) const;
+        const FacilityType *data() const;
+        const_iterator begin() const;
+        const_iterator end() const;
+        void push_back(const FacilityType &facility);
+        void clear();
+
+        const int *lifeQualityScores() const;
+        const int *economyScores() const;
+        const int *environmentScores() const;
+
+        bool hasCategory(FacilityCategory category) const;
+        // The first type of the category after index after, wrapping around to
+        // the first one of the category; SIZE_MAX if the category has none.
+        // position is the caller's place in the category, which makes walking
+        // a category in order O(1) a pick; any value is accepted.
+        size_t nextInCategory(FacilityCategory category, long long after, size_t &position) const;
+
+        // Builds the balanced index if the catalog is large enough to need one.
+        // Not thread safe; called before plans step, while nothing reads it.
+        void prepare();
+        // Null until prepare() builds it
+        const BalancedIndex *balancedIndex() const;
+        // The order for these weights. Built on first use and kept if the
+        // catalog is prepared, so that every plan with the weights shares it;
+        // thread safe.
+        std::shared_ptr<const WeightedOrder> weightedOrder(double lifeQualityWeight, double economyWeight, double environmentWeight) const;
+        // Changes whenever a type is added or the catalog is cleared, and is
+        // never the same for two catalogs with different types; copies keep it
+        unsigned long long version() const;
+
+    private:
+        vector<FacilityType> types;
+        vector<int> lifeQuality;
+        vector<int> economy;
+        vector<int> environment;
+        struct WeightedOrders; // The orders built so far, behind a lock
+
+        std::shared_ptr<const BalancedIndex> index;
+        std::shared_ptr<WeightedOrders> weightedOrders; // Shared with copies; null until prepare()
+        unsigned long long contentVersion;
+        vector<size_t> categoryTypes[3]; // Indexed by FacilityCategory
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "SharedChunkList.h"
+using std::vector;
+
+// Compact structure-of-arrays storage for the facilities of one plan.
+// A facility is kept as its index into the simulation's facilitiesOptions
+// instead of a heap allocated Facility copy. Its status is implied by the
+// list it is in: operational facilities only need their type index, while
+// facilities under construction keep the step they finish on in a parallel
+// array.
+//
+// Finish steps act as a completion schedule: the store counts the steps it
+// has been through and remembers the nearest finish step, so a step on which
+// nothing finishes touches no facility at all. A plan never has more than its
+// construction limit (at most 3) facilities pending, so the nearest finish
+// step is the only bucket of the timing wheel that has to be tracked.
+//
+// The operational list only grows, so it is a SharedChunkList: copying a
+// store (and with it a plan) shares the list until one of the copies builds.
+class FacilityStore {
+    public:
+        FacilityStore();
+
+        size_t operationalCount() const;
+        int getOperationalType(size_t i) const;
+        void addOperational(int typeIndex);
+        void clearOperational();
+
+        size_t underConstructionCount() const;
+        int getUnderConstructionType(size_t i) const;
+        int getTimeLeft(size_t i) const;
+        void addUnderConstruction(int typeIndex, int timeLeft);
+        void clearUnderConstruction();
+        long long getClock() const;
+
+        // Advances one step and moves the facilities that finish on it to the
+        // operational list in one batch, keeping their order. Returns how many
+        // facilities became operational; their type indices are the last ones
+        // in the operational list.
+        size_t stepConstruction();
+
+        // Fast-forward support: appends the operational facilities from index
+        // `from` to the end another `times` times, and moves the clock and every
+        // pending finish step `steps` steps ahead.
+        void repeatOperational(size_t from, long long times);
+        void skipSteps(long long steps);
+
+    private:
+        void updateNextFinish();
+
+        long long clock; // Steps this store has been through
+        long long nextFinish; // Nearest finish step, NEVER if nothing will finish
+        SharedChunkList<int> operationalTypes;
+        vector<int> constructionTypes;
+        vector<long long> constructionFinish;
+
+        static const long long NEVER;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "Plan.h"
+#include "SlabPool.h"
+using std::string;
+using std::vector;
+
+// The simulation's plans ranked by each score, for top-K queries. Each metric
+// keeps an ordered set of (score, plan) with the best plan first, so the top
+// K are the set's first K entries. Plans are ranked by their position in the
+// simulation's plans vector, and equal scores rank in that order.
+//
+// The board remembers the scores each plan was ranked with. After a step,
+// update() marks the plans whose scores have changed since; the next query
+// re-ranks those, and the plans added since, before reading the top K.
+// Copies share the rankings until one of them re-ranks, so a backup doesn't
+// copy them.
+//
+// So only a query with nothing to re-rank costs O(K). One that follows
+// changes to d plans costs O(d log n) on top, and once d reaches an eighth of
+// the n plans, as it does after a step in which many plans finish a facility,
+// all four rankings are rebuilt at O(n log n). Queries right after every step
+// of a large simulation therefore cost about as much as sorting the plans.
+class Leaderboard {
+    public:
+        enum Metric {
+            LIFE_QUALITY, ECONOMY, ENVIRONMENT,
+            BALANCED, // The plan's lowest score
+            METRIC_COUNT
+        };
+
+        Leaderboard();
+
+        // "life", "economy", "env" or "balanced"
+        static bool parseMetric(const string &name, Metric &metric);
+        static const char *metricName(Metric metric);
+
+        void update(const vector<Plan> &plans);
+        void clear(); // After the plans were replaced wholesale
+        // Positions of the best count plans, best first; re-ranks first (see above)
+        void top(const vector<Plan> &plans, Metric metric, size_t count, vector<size_t> &positions);
+
+    private:
+        struct Scores {
+            int lifeQuality, economy, environment;
+            bool operator==(const Scores &other) const;
+        };
+        struct Ranked {
+            long long score;
+            size_t position;
+            bool operator<(const Ranked &other) const; // Higher score first
+        };
+        typedef std::set<Ranked, std::less<Ranked>, PoolAllocator<Ranked>> Ranking;
+        struct Rankings {
+            Rankings() : ranked(), byMetric() {}
+            vector<Scores> ranked; // The scores each plan is ranked with, by position
+            Ranking byMetric[METRIC_COUNT];
+        };
+
+        static Scores scoresOf(const Plan &plan);
+        static long long score(const Scores &scores, int metric);
+        void rerank(const vector<Plan> &plans);
+        void rebuild(const vector<Plan> &plans);
+
+        // Rankings are rebuilt once at least 1 / REBUILD_SHARE of the plans moved
+        static const size_t REBUILD_SHARE = 8;
+
+        std::shared_ptr<Rankings> rankings;
+        vector<size_t> changed; // Positions of ranked plans to re-rank
+        vector<bool> isChanged;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <string>
+using std::string;
+
+// A whole file mapped read-only into memory, unmapped when it goes out of
+// scope. An empty file is open but has no data.
+class MappedFile {
+    public:
+        MappedFile(const string &path);
+        ~MappedFile();
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        bool isOpen() const;
+        const char *data() const;
+        size_t size() const;
+
+    private:
+        bool opened;
+        const char *contents;
+        size_t length;
+};
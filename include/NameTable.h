@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+typedef uint32_t Symbol;
+
+// Every name in the program, stored once and referred to by a 32-bit symbol:
+// facility types, settlements and the strings actions are logged with.
+// Symbols are never freed, so a symbol means the same name in every simulation,
+// backup and log of the process.
+//
+// Names are found through an open addressing hash over the symbols, so each
+// name is kept only once. Interning is not thread safe; names are interned on
+// the main thread, never while plans step on others.
+class NameTable {
+    public:
+        static const Symbol NONE = 0xffffffffu;
+
+        static Symbol intern(const string &name);
+        static Symbol find(const string &name); // NONE if the name was never interned
+        static const string &name(Symbol symbol); // Empty for NONE
+        static size_t size();
+
+    private:
+        NameTable();
+        static NameTable &instance();
+        static uint32_t hash(const string &name);
+        size_t slotOf(const string &name) const; // Of the name, or the empty slot it would take
+        void grow();
+
+        std::deque<string> names; // By symbol; a deque, so names never move
+        vector<Symbol> slots; // NONE when empty
+};
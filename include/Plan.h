@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include "Facility.h"
+#include "FacilityStore.h"
+#include "NameTable.h"
 #include "Settlement.h"
 #include "SelectionPolicy.h"
 
@@ -13,17 +15,27 @@ enum class PlanStatus {
     BUSY,
 };
 
+// A plan refers to its settlement by index into the simulation's settlements
+// and holds no reference into the simulation, so plans can be copied or moved
+// between simulations (backups, snapshots, checkpoints) as they are. The
+// facility catalog the plan's type indices refer to is passed in by whoever
+// steps or prints it.
 class Plan {
 public:
-    // Constructor
-    Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions);
+    // Constructor; settlement is the simulation's settlement at settlementIndex,
+    // of which the plan keeps only the name and construction limit
+    Plan(const int planId, size_t settlementIndex, const Settlement &settlement, SelectionPolicy *selectionPolicy);
 
     // Copy constructor
     Plan(const Plan &other);
-    Plan(const Plan &other, const Settlement& settlement);
+
+    // Move constructor; takes the policy and shares the facilities, so plans
+    // are relocated (as when the plans vector grows) without copying either
+    Plan(Plan &&other) noexcept;
 
     // Copy assignment operator
     Plan& operator=(const Plan &other);
+    Plan& operator=(Plan &&other) noexcept;
 
     // Destructor
     ~Plan();
@@ -34,27 +46,43 @@ public:
     const int getEnvironmentScore() const;
     void setSelectionPolicy(SelectionPolicy *selectionPolicy);
     const SelectionPolicy* getSelectionPolicy() const;
-    const Settlement& getSettlement() const;
-    void step();
-    void printStatus();
-    const vector<Facility*> &getFacilities() const;
-    const vector<Facility*> &getUnderConstructionFacilities() const;
-    void addFacility(Facility* facility);
-    void addUnderConstructionFacility(Facility* facility);
-    const string toString() const;
+    size_t getSettlementIndex() const;
+    const string &getSettlementName() const;
+    int getConstructionLimit() const;
+    void step(const FacilityCatalog &facilityOptions);
+    void step(int numOfSteps, const FacilityCatalog &facilityOptions);
+    void printStatus(const FacilityCatalog &facilityOptions) const;
+    const FacilityStore &getFacilities() const;
+    void setFacilities(const FacilityStore &facilities);
+    PlanStatus getStatus() const;
+    void setStatus(PlanStatus status);
+    void addFacility(int typeIndex);
+    void addUnderConstructionFacility(int typeIndex, const FacilityCatalog &facilityOptions);
+    const string toString(const FacilityCatalog &facilityOptions) const;
     const string shortenedToString() const;
     void setScores(int lifeQualityScore, int economyScore, int environmentScore);
     const int getPlanID() const;
     void clearFacilities();
     void clearUnderConstructionFacilities();
+    // Changes whenever the plan does and is never reused, so two plans with
+    // the same version hold the same state (one is a copy of the other)
+    unsigned long long getVersion() const;
+
+    // Below this many steps detecting a cycle costs more than it saves
+    static const int FAST_FORWARD_MIN_STEPS = 128;
 
 private:
+    void stepOnce(const FacilityCatalog &facilityOptions);
+    void touch();
+    void getCycleKey(vector<long long> &key, vector<long long> &counters) const;
+
     int plan_id;
-    const Settlement &settlement; // Reference to avoid deep copying
+    size_t settlementIndex;
+    Symbol settlementName;
+    int constructionLimit; // The settlement's; settlements never change
     SelectionPolicy *selectionPolicy; // Raw pointer to allow dynamic behavior
     PlanStatus status;
-    vector<Facility*> facilities;
-    vector<Facility*> underConstruction;
-    const vector<FacilityType> &facilityOptions; // Reference for efficient handling
+    FacilityStore facilities; // Operational and under construction facilities
     int life_quality_score, economy_score, environment_score;
+    unsigned long long version;
 };
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Plan.h"
+using std::vector;
+
+// Totals over a set of plans
+struct PlanTotals {
+    size_t plans, busyPlans;
+    size_t operationalFacilities, underConstructionFacilities;
+    long long lifeQualityScore, economyScore, environmentScore;
+};
+
+// Running totals of the simulation's plans, per settlement and overall. The
+// stats remember what each plan was counted with, so bringing them up to
+// date after a step costs a comparison per plan and O(1) per plan that
+// changed, and copies (backups) carry totals that match their plans.
+class PlanStats {
+    public:
+        PlanStats();
+
+        // Counts a plan added after those already counted, in O(1)
+        void add(const Plan &plan);
+        // Counts the changes of the plans already counted, and any added since;
+        // a comparison per plan, for after a step
+        void update(const vector<Plan> &plans);
+        void clear(); // After the plans were replaced wholesale
+
+        const PlanTotals &total() const;
+        PlanTotals settlementTotal(size_t settlementIndex) const; // Zero for a settlement without plans
+
+    private:
+        struct Counted {
+            int lifeQuality, economy, environment;
+            size_t operational, underConstruction;
+            bool busy;
+            bool operator==(const Counted &other) const;
+        };
+
+        static Counted countedOf(const Plan &plan);
+        void apply(size_t settlementIndex, const Counted &counted, long long sign);
+        static void apply(PlanTotals &totals, const Counted &counted, long long sign);
+
+        vector<Counted> counted; // What each plan is counted with, by position
+        vector<PlanTotals> settlements; // By settlement index
+        PlanTotals totals;
+};
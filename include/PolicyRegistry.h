@@ -0,0 +1,28 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <unordered_map>
+using std::string;
+
+class SelectionPolicy;
+
+// Makes a policy for a plan whose scores so far are lifeQuality, economy and
+// environment. parameters is what follows the ':' in a parameterized name,
+// such as "1,2,0.5" in "w:1,2,0.5". Returns null if the parameters are invalid.
+typedef std::function<SelectionPolicy *(const string &parameters, int lifeQuality, int economy, int environment)> PolicyFactory;
+
+// Selection policies by name. A name ending in ':' registers a family of
+// parameterized policies, which is looked up by the part of a policy's name
+// up to and including its first ':'.
+class PolicyRegistry {
+    public:
+        PolicyRegistry();
+        // Adding a name again replaces the factory
+        void add(const string &name, const PolicyFactory &factory);
+        // A new policy, owned by the caller, or null if the name is unknown or
+        // its parameters are invalid
+        SelectionPolicy *create(const string &name, int lifeQuality = 0, int economy = 0, int environment = 0) const;
+
+    private:
+        std::unordered_map<string, PolicyFactory> factories;
+};
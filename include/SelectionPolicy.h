@@ -1,22 +1,57 @@
 #pragma once
+#include <memory>
+#include <utility>
 #include <vector>
-#include "Facility.h"
+#include "FacilityCatalog.h"
 using std::vector;
 
+class FacilityStore;
+
+// What a plan tells its policy about itself when it asks for a pick
+struct SelectionContext {
+    int lifeQuality; // Scores of the plan's operational facilities
+    int economy;
+    int environment;
+    int constructionLimit;
+    const FacilityStore *facilities; // The plan's facilities, those under construction included
+};
+
 class SelectionPolicy {
     public:
-        virtual const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) = 0;
+        virtual const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) = 0;
+        // The pick for a plan in the given state. Plans pick through this;
+        // by default it ignores the plan and calls selectFacility.
+        virtual const FacilityType& selectFacilityFor(const FacilityCatalog &facilitiesOptions, const SelectionContext &context);
         virtual const string toString() const = 0;
         virtual SelectionPolicy* clone() const = 0;
         virtual ~SelectionPolicy() = default;
+
+        // The values the policy carries from pick to pick, for checkpoints
+        virtual void getState(vector<long long> &state) const;
+        virtual void setState(const vector<long long> &state);
+
+        // Fast-forward support (see Plan::step(int)). Fills key with what the
+        // next picks depend on and counters with values that only accumulate
+        // from pick to pick. Returns false if the picks can't be shown to repeat.
+        virtual bool getCycleState(vector<long long> &key, vector<long long> &counters) const;
+        // Adds the growth of the counters over the skipped cycles
+        virtual void skipCycles(const vector<long long> &counterDeltas);
+
+        // Whether state, saved by getState, can be given to setState
+        virtual bool acceptsState(const vector<long long> &state) const;
+        // The category the policy picks from, if it only picks from one
+        virtual bool pickedCategory(FacilityCategory &category) const;
 };
 
 class NaiveSelection: public SelectionPolicy {
     public:
         NaiveSelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
         const string toString() const override;
         NaiveSelection *clone() const override;
+        void getState(vector<long long> &state) const override;
+        void setState(const vector<long long> &state) override;
+        bool getCycleState(vector<long long> &key, vector<long long> &counters) const override;
         ~NaiveSelection() override = default;
     private:
         int lastSelectedIndex;
@@ -25,9 +60,13 @@ class NaiveSelection: public SelectionPolicy {
 class BalancedSelection: public SelectionPolicy {
     public:
         BalancedSelection(int LifeQualityScore, int EconomyScore, int EnvironmentScore);
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
         const string toString() const override;
         BalancedSelection *clone() const override;
+        void getState(vector<long long> &state) const override;
+        void setState(const vector<long long> &state) override;
+        bool getCycleState(vector<long long> &key, vector<long long> &counters) const override;
+        void skipCycles(const vector<long long> &counterDeltas) override;
         ~BalancedSelection() override = default;
     private:
         int LifeQualityScore;
@@ -38,22 +77,112 @@ class BalancedSelection: public SelectionPolicy {
 class EconomySelection: public SelectionPolicy {
     public:
         EconomySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
         const string toString() const override;
         EconomySelection *clone() const override;
+        void getState(vector<long long> &state) const override;
+        void setState(const vector<long long> &state) override;
+        bool getCycleState(vector<long long> &key, vector<long long> &counters) const override;
+        bool pickedCategory(FacilityCategory &category) const override;
         ~EconomySelection() override = default;
     private:
         int lastSelectedIndex;
+        size_t categoryPosition; // Where lastSelectedIndex is among the category's types
 
 };
 
 class SustainabilitySelection: public SelectionPolicy {
     public:
         SustainabilitySelection();
-        const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
         const string toString() const override;
         SustainabilitySelection *clone() const override;
+        void getState(vector<long long> &state) const override;
+        void setState(const vector<long long> &state) override;
+        bool getCycleState(vector<long long> &key, vector<long long> &counters) const override;
+        bool pickedCategory(FacilityCategory &category) const override;
         ~SustainabilitySelection() override = default;
     private:
         int lastSelectedIndex;
-};
\ No newline at end of file
+        size_t categoryPosition; // Where lastSelectedIndex is among the category's types
+};
+
+// Picks the type with the highest weighted sum of scores, with diminishing
+// returns: a type's value is divided by one more than the number of times the
+// plan picked it (multiplied, if negative). The types ranked by their sums
+// come from a WeightedOrder that every plan with the same weights shares, so
+// the best type the plan never picked is the first unpicked one in that
+// order. The plan itself only keeps counts for the types it picked, with a
+// heap of their values; a pick compares the top of the heap with the best
+// unpicked type. Ties go to the type added first. Named
+// w:<lifeQuality>,<economy>,<environment> after its weights, such as w:1,2,0.5.
+class WeightedSelection: public SelectionPolicy {
+    public:
+        WeightedSelection(const string &name, double lifeQualityWeight, double economyWeight, double environmentWeight);
+        // Null unless weights is three comma separated numbers
+        static WeightedSelection *fromWeights(const string &weights);
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
+        const string toString() const override;
+        WeightedSelection *clone() const override;
+        void getState(vector<long long> &state) const override;
+        void setState(const vector<long long> &state) override;
+        bool acceptsState(const vector<long long> &state) const override;
+        ~WeightedSelection() override = default;
+    private:
+        struct Candidate {
+            double value;
+            size_t index;
+            bool operator<(const Candidate &other) const; // Heap order: the best candidate is largest
+        };
+
+        // Type index's value once picked that many times
+        double valueOf(size_t index, long long picked) const;
+        // Where type index is in picks, or where it would go
+        vector<std::pair<size_t, long long>>::iterator findPicks(size_t index);
+
+        string name;
+        double lifeQualityWeight;
+        double economyWeight;
+        double environmentWeight;
+        std::shared_ptr<const WeightedOrder> order; // Null until the first pick
+        vector<std::pair<size_t, long long>> picks; // Type and times picked, for each type picked, by type
+        vector<Candidate> candidates; // A heap of the types in picks
+        bool candidatesValid; // False once picks or order were replaced, until the heap is rebuilt
+        size_t nextUnpicked; // Position in order; every type before it was picked
+};
+
+// Plans the next depth picks ahead: every sequence of that many picks is
+// played out against the plan's construction limit and the types' build
+// times, as the plan itself would step, until everything picked is built.
+// The first pick of the best sequence is taken, the best sequence being the
+// one that leaves the plan's lowest score highest, then finishes soonest,
+// then leaves the highest total score; ties go to the type added first.
+//
+// Types that another type matches or beats on every score and on build time
+// are never picked. Positions reached through different orders of picks are
+// searched once, through a transposition cache kept across picks; positions
+// that only differ by the same amount on all three scores share an entry.
+// Large searches split the candidate first picks over threads, each with its
+// own cache. Named lookahead:<depth>.
+class LookaheadSelection: public SelectionPolicy {
+    public:
+        LookaheadSelection(int depth);
+        LookaheadSelection(const LookaheadSelection &other); // The cache is not copied
+        LookaheadSelection &operator=(const LookaheadSelection &other) = delete;
+        // Null unless depth is a number from 1 to MAX_DEPTH
+        static LookaheadSelection *fromDepth(const string &depth);
+        // As for a plan with nothing built and one construction slot
+        const FacilityType& selectFacility(const FacilityCatalog &facilitiesOptions) override;
+        const FacilityType& selectFacilityFor(const FacilityCatalog &facilitiesOptions, const SelectionContext &context) override;
+        const string toString() const override;
+        LookaheadSelection *clone() const override;
+        ~LookaheadSelection() override;
+
+        static const int MAX_DEPTH = 5;
+
+    private:
+        class Search;
+
+        int depth;
+        std::unique_ptr<Search> search; // Null until the first pick
+};
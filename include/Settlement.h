@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "NameTable.h"
 using std::string;
 using std::vector;
 
@@ -16,11 +17,12 @@ class Settlement {
     public:
         Settlement(const string &name, SettlementType type);
         const string &getName() const;
+        Symbol getNameSymbol() const;
         SettlementType getType() const;
         const string toString() const;
         const int getConstructionLimit() const;
 
         private:
-            const string name;
+            const Symbol name;
             SettlementType type;
 };
\ No newline at end of file
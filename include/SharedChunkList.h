@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "SlabPool.h"
+using std::vector;
+
+// Append-only list whose copies share structure. Elements live in fixed-size
+// chunks, and the list of chunks is itself shared, so copying the list copies
+// one pointer. A copy only separates from the list it was made from when it
+// is appended to or cleared. Then it copies the chunk directory and, if it is
+// not full, the last chunk; full chunks are never copied.
+//
+// A chunk and its reference count are one block from a SlabPool, so appending
+// to a list, or to a copy that has just separated, does not reach the heap
+// once the pool has grown to the lists' working size.
+template <typename T, size_t ChunkSize = 256>
+class SharedChunkList {
+    public:
+        static const size_t CHUNK_SIZE = ChunkSize;
+
+        SharedChunkList() : directory(std::make_shared<Directory>()), count(0) {}
+        // Copying is already a pointer copy; no move operations, so a moved
+        // from list is never left without a directory
+        SharedChunkList(const SharedChunkList &other) = default;
+        SharedChunkList &operator=(const SharedChunkList &other) = default;
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        const T &operator[](size_t i) const {
+            return (*directory)[i / CHUNK_SIZE]->items[i % CHUNK_SIZE];
+        }
+
+        void push_back(const T &value) {
+            if (directory.use_count() > 1) {
+                directory = std::make_shared<Directory>(*directory);
+            }
+            if (count % CHUNK_SIZE == 0) {
+                directory->push_back(std::allocate_shared<Chunk>(PoolAllocator<Chunk>()));
+            } else if (directory->back().use_count() > 1) {
+                directory->back() = std::allocate_shared<Chunk>(PoolAllocator<Chunk>(), *directory->back());
+            }
+            Chunk &chunk = *directory->back();
+            chunk.items[chunk.size++] = value;
+            count++;
+        }
+
+        size_t chunkCount() const {
+            return directory->size();
+        }
+
+        // The elements of one chunk, which are contiguous
+        const T *chunkData(size_t chunk, size_t &chunkSize) const {
+            chunkSize = (*directory)[chunk]->size;
+            return (*directory)[chunk]->items;
+        }
+
+        // Drops the oldest chunk, which must be full
+        void popFrontChunk() {
+            if (directory.use_count() > 1) {
+                directory = std::make_shared<Directory>(*directory);
+            }
+            count -= directory->front()->size;
+            directory->erase(directory->begin());
+        }
+
+        void clear() {
+            directory = std::make_shared<Directory>();
+            count = 0;
+        }
+
+    private:
+        // Items past size are left uninitialized and are not copied
+        struct Chunk {
+            Chunk() : size(0) {}
+            Chunk(const Chunk &other) : size(other.size) {
+                std::copy(other.items, other.items + size, items);
+            }
+            Chunk &operator=(const Chunk &other) = delete;
+
+            size_t size;
+            T items[ChunkSize];
+        };
+        typedef vector<std::shared_ptr<Chunk>> Directory;
+
+        std::shared_ptr<Directory> directory;
+        size_t count;
+};
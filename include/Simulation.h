@@ -1,9 +1,17 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 #include "Facility.h"
 #include "Plan.h"
 #include "Settlement.h"
+#include "StepEngine.h"
+#include "ActionLog.h"
+#include "Leaderboard.h"
+#include "PlanStats.h"
+#include "CommandTable.h"
+#include "PolicyRegistry.h"
 using std::string;
 using std::vector;
 
@@ -12,8 +20,9 @@ class SelectionPolicy;
 
 class Simulation {
 public:
-    // Default Constructor
-    Simulation(const string &configFilePath);
+    // Default Constructor; large config files are loaded on threadCount threads,
+    // which the simulation then also steps on
+    Simulation(const string &configFilePath, int threadCount = 1);
 
     // Rule of 5
     ~Simulation();                                  // Destructor
@@ -24,30 +33,85 @@ public:
 
     // Public Methods
     void start();
-    void addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy);
-    void addAction(BaseAction *action);
+    void startBatch(const string &commandFilePath); // Runs a command file, without prompts
+    // Adds a command, or replaces one, for start() and startBatch() to run
+    // (see CommandTable for the argument spec)
+    void registerCommand(const string &name, const string &argumentSpec, const CommandHandler &handler);
+    // Adds a selection policy, or replaces one, for plans to be created with
+    // (see PolicyRegistry for parameterized names)
+    void registerPolicy(const string &name, const PolicyFactory &factory);
+    // A new policy for a plan with the given scores; null if the name is unknown
+    SelectionPolicy *createPolicy(const string &name, int lifeQuality = 0, int economy = 0, int environment = 0) const;
+    // Whether a plan with the policy can pick: it has a facility type in the
+    // category the policy picks from, if any
+    bool canPickWith(const SelectionPolicy &selectionPolicy) const;
+    // Acts an action and logs it, unless acting throws
+    void runAction(BaseAction &action);
+    void addPlan(size_t settlementIndex, SelectionPolicy *selectionPolicy);
+    void addAction(const BaseAction &action); // Logs a record of the action
     bool addSettlement(Settlement *settlement);
     bool addFacility(FacilityType facility);
     bool isSettlementExists(const string &settlementName);
     Settlement &getSettlement(const string &settlementName);
+    size_t getSettlementIndex(const string &settlementName) const; // Into the settlements, in the order added
     Plan &getPlan(const int planID);
     bool planExists(const int planID);
     bool isFacilityExist(const string &facilityName);
     vector<Plan>& getPlans();
+    const FacilityCatalog &getFacilityCatalog() const; // What plans' facility type indices refer to
+    // Positions in getPlans() of the best count plans by the metric, best first
+    void topPlans(Leaderboard::Metric metric, size_t count, vector<size_t> &positions);
+    const PlanStats &getPlanStats() const; // Totals of the plans, per settlement and overall
     void step();
+    void step(int numOfSteps);
+    void setThreadCount(int threadCount);
     void close();
     void open();
-    const std::vector<BaseAction *> &getActionsLog() const;
+    const ActionLog &getActionsLog() const;
+    // Keeps about capacity log entries in memory, the older ones in the file at path
+    void spillActionsLog(const string &path, size_t capacity);
     void backUp(); // Create a backup of the current simulation state
     void restore();
+    void backUp(const string &name); // Named backups, kept as deltas (see SnapshotStore)
+    void restore(const string &name);
+    bool backupExists(const string &name) const;
+    void saveCheckpoint(const string &path) const; // Binary checkpoint files (see Checkpoint)
+    void loadCheckpoint(const string &path);
 
 private:
+    friend class SnapshotStore;
+    friend class Checkpoint;
+    friend class ConfigLoader;
+    bool runCommand(const string &input);
+    void registerBuiltinCommands();
+    void registerBuiltinPolicies();
+    void stepPlans(int numOfSteps);
+    void plansChanged(); // Brings the leaderboard and stats up to date
+    bool canStepPlansIndependently() const;
+    void rebuildIndexes(); // After settlements, facilitiesOptions or plans were replaced wholesale; also re-ranks the plans
+
     bool isRunning;
     int planCounter; // For assigning unique plan IDs
-    vector<BaseAction *> actionsLog;
-    vector<Settlement *> settlements;
-    vector<FacilityType> facilitiesOptions;
+    // Logged actions and settlements never change once added, so copies of the
+    // simulation (backups) share them instead of cloning them
+    ActionLog actionsLog;
+    vector<std::shared_ptr<Settlement>> settlements;
+    FacilityCatalog facilitiesOptions;
     vector<Plan> plans;
+    Leaderboard leaderboard; // Told by step which plans' scores changed
+    PlanStats planStats; // Brought up to date by addPlan and step
+    StepEngine stepEngine;
+    // Lookup indexes into settlements, plans and facilitiesOptions. Names keep
+    // their first occurrence, like the scans they replace did.
+    std::unordered_map<Symbol, size_t> settlementIndex;
+    std::unordered_map<int, size_t> planIndex;
+    std::unordered_map<Symbol, size_t> facilityIndex;
+    // Commands by name. Assigning a simulation, as restoring a backup does,
+    // keeps the commands it had.
+    CommandTable commands;
+    string unknownCommand; // Scratch for runCommand
+    // Selection policies by name; kept on assignment like the commands
+    PolicyRegistry policies;
 };
 
 
@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+using std::vector;
+
+// Fixed-size blocks carved out of large slabs. Freed blocks go on a free list
+// and are handed out again, so a steady stream of same-sized allocations stops
+// reaching the heap once the pool has grown to fit it, and freeing a block is
+// a push on a list rather than a call to free.
+//
+// Memory is never given back to the system while the pool exists: a freed
+// block only returns to the free list, and slabs are released by the pool's
+// destructor alone. Pools reached through PoolAllocator are never destroyed,
+// so what they grow to stays allocated until the process ends.
+//
+// Thread safe. Threads allocate through a LocalCache of their own, which
+// takes and returns blocks in batches, so most allocations and releases take
+// no lock.
+class SlabPool {
+    private:
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+    public:
+        // One thread's spare blocks. Plain data, so it can be a thread_local
+        // that outlives the thread's other thread_locals (see Retirer).
+        struct LocalCache {
+            FreeBlock *blocks;
+            size_t count;
+            bool retired; // Past the thread's end; blocks go straight to the pool
+        };
+
+        // Gives a thread's cached blocks back to the pool when the thread ends
+        class Retirer {
+            public:
+                Retirer(SlabPool &pool, LocalCache &cache);
+                ~Retirer();
+                Retirer(const Retirer &other) = delete;
+                Retirer &operator=(const Retirer &other) = delete;
+
+            private:
+                SlabPool &pool;
+                LocalCache &cache;
+        };
+
+        SlabPool(size_t blockSize, size_t blocksPerSlab);
+        ~SlabPool();
+        SlabPool(const SlabPool &other) = delete;
+        SlabPool &operator=(const SlabPool &other) = delete;
+
+        void *allocate();
+        void release(void *block);
+        void *allocate(LocalCache &cache);
+        void release(LocalCache &cache, void *block);
+        size_t slabCount() const;
+
+        // Slabs are about this large, with at least MIN_BLOCKS_PER_SLAB blocks
+        static const size_t SLAB_BYTES = 1 << 18;
+        static const size_t MIN_BLOCKS_PER_SLAB = 8;
+        // Blocks a cache takes or returns at once, at most
+        static const size_t MAX_BATCH = 32;
+
+    private:
+        void addSlab();
+        void retire(LocalCache &cache);
+
+        size_t blockSize;
+        size_t blocksPerSlab;
+        size_t batch; // Blocks a cache takes or returns at once
+        vector<char *> slabs;
+        FreeBlock *freeBlocks;
+        mutable std::mutex mutex;
+};
+
+// An allocator that takes single objects from a SlabPool shared by every
+// allocator for the same type, and arrays from the heap. Made for
+// std::allocate_shared, which allocates an object and its reference count as
+// one block of a type only the library knows.
+template <typename T>
+class PoolAllocator {
+    public:
+        typedef T value_type;
+
+        PoolAllocator() {}
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U> &) {}
+
+        T *allocate(size_t n) {
+            if (n != 1) {
+                return static_cast<T *>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T *>(pool().allocate(localCache()));
+        }
+
+        void deallocate(T *pointer, size_t n) {
+            if (n != 1) {
+                ::operator delete(pointer);
+                return;
+            }
+            pool().release(localCache(), pointer);
+        }
+
+        // The pool for T. Never destroyed, so objects that outlive main, such as
+        // those of static backups, can still be released into it.
+        static SlabPool &pool() {
+            static SlabPool *pool = new SlabPool(sizeof(T),
+                std::max(SlabPool::MIN_BLOCKS_PER_SLAB, SlabPool::SLAB_BYTES / sizeof(T)));
+            return *pool;
+        }
+
+    private:
+        // The calling thread's cache for the pool, retired when the thread ends
+        static SlabPool::LocalCache &localCache() {
+            static thread_local SlabPool::LocalCache cache = {nullptr, 0, false};
+            static thread_local SlabPool::Retirer retirer(pool(), cache);
+            return cache;
+        }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) {
+    return false;
+}
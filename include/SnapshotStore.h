@@ -0,0 +1,50 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+// Named backups of a simulation, kept as a chain of deltas. Each snapshot
+// only records what changed since its parent, which is the snapshot that was
+// saved or restored last: the plans whose version differs, and the
+// settlements and facility types added since. Unchanged plans, settlements
+// and facility types are looked up further up the chain, and the actions log
+// shares its chunks with the parent's log.
+class SnapshotStore {
+    public:
+        SnapshotStore();
+        void save(const string &name, const Simulation &simulation);
+        void restore(const string &name, Simulation &simulation);
+        bool contains(const string &name) const;
+
+    private:
+        struct Snapshot {
+            Snapshot(const std::shared_ptr<const Snapshot> &parent);
+
+            std::shared_ptr<const Snapshot> parent;
+            int planCounter;
+            size_t planCount;
+            vector<size_t> changedPlanIndices;
+            vector<Plan> changedPlans;
+            size_t keptSettlements; // Leading settlements taken from the parent
+            vector<std::shared_ptr<Settlement>> addedSettlements;
+            size_t keptFacilities; // Leading facility types taken from the parent
+            vector<FacilityType> addedFacilities;
+            ActionLog actionsLog;
+        };
+
+        // Rebuilds the full state a snapshot stands for
+        static void materialize(const Snapshot &snapshot, vector<const Plan *> &plans,
+            vector<std::shared_ptr<Settlement>> &settlements, vector<FacilityType> &facilities);
+
+        std::map<string, std::shared_ptr<const Snapshot>> snapshots;
+        // The snapshot the live simulation was last saved to or restored from,
+        // with its settlements, facility types and plan versions
+        std::shared_ptr<const Snapshot> head;
+        vector<std::shared_ptr<Settlement>> headSettlements;
+        vector<FacilityType> headFacilities;
+        vector<unsigned long long> headVersions;
+};
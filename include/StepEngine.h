@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "Plan.h"
+using std::vector;
+
+// Advances a set of plans by a number of steps on a pool of worker threads.
+// Every plan only touches its own facilities, scores and selection policy, so
+// plans are split into ranges that each worker owns; a worker that runs out
+// of work steals the back half of another worker's remaining range.
+class StepEngine {
+    public:
+        StepEngine(int threadCount);
+        int getThreadCount() const;
+        void setThreadCount(int threadCount);
+        // Steps every plan numOfSteps times, plan after plan.
+        void run(vector<Plan> &plans, const FacilityCatalog &facilityOptions, int numOfSteps) const;
+        // Whether the calling thread is stepping plans next to other threads,
+        // so work started from a plan's step shouldn't start threads of its own
+        static bool inParallelRun();
+
+        // Plans handed out per grab, so tiny scenarios stay on one thread
+        static const size_t GRAIN_SIZE = 64;
+
+    private:
+        int threadCount;
+};
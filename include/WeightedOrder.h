@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+using std::vector;
+
+class FacilityCatalog;
+
+// WeightedSelection's ranking of a catalog's types for one set of weights:
+// each type's weighted sum of scores, and the types from the highest sum
+// down, ties going to the type added first. Immutable once built; the
+// catalog keeps one per set of weights (see FacilityCatalog::weightedOrder)
+// for every plan that picks with those weights to share.
+class WeightedOrder {
+    public:
+        WeightedOrder(const FacilityCatalog &catalog, double lifeQualityWeight, double economyWeight, double environmentWeight);
+        bool hasWeights(double lifeQualityWeight, double economyWeight, double environmentWeight) const;
+        // Whether the order was built from the catalog as it is now
+        bool isFor(const FacilityCatalog &catalog) const;
+
+        size_t size() const;
+        double valueOf(size_t index) const; // The weighted sum of type index's scores
+        size_t at(size_t position) const; // The type at position, the best one first
+
+    private:
+        double lifeQualityWeight;
+        double economyWeight;
+        double environmentWeight;
+        unsigned long long catalogVersion;
+        vector<double> values; // By type
+        vector<size_t> order;
+};
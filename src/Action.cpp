@@ -1,6 +1,8 @@
 #include "Action.h"
 #include "Auxiliary.h"
 #include "Simulation.h"
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -8,9 +10,23 @@
 #include <string>
 #include <stdexcept>
 
+namespace {
+    ActionRecord makeRecord(ActionKind kind, ActionStatus status, int value,
+                            Symbol first = NameTable::NONE, Symbol second = NameTable::NONE) {
+        ActionRecord record = {kind, status, 0, value, {first, second}};
+        return record;
+    }
+
+    string describe(ActionKind kind, int value, const string &first = "", const string &second = "") {
+        string text;
+        ActionLog::describe(kind, value, first, second, text);
+        return text;
+    }
+}
+
 // BaseAction Implementation
 BaseAction::BaseAction()
-    : errorMsg("Error: <error_msg>"), status(ActionStatus::COMPLETED) {}
+    : errorMsg(), status(ActionStatus::COMPLETED) {}
 
 ActionStatus BaseAction::getStatus() const {
     return status;
@@ -33,16 +49,16 @@ const std::string &BaseAction::getErrorMsg() const {
 SimulateStep::SimulateStep(const int numOfSteps) : numOfSteps(numOfSteps) {}
 
 void SimulateStep::act(Simulation &simulation) {
-    for (int i = 0; i < numOfSteps; i++) {
-        for(Plan& plan : simulation.getPlans()){
-            plan.step();
-        }
-    }
+    simulation.step(numOfSteps);
     complete();
 }
 
 const std::string SimulateStep::toString() const {
-    return "step " + std::to_string(numOfSteps);
+    return describe(ActionKind::STEP, numOfSteps);
+}
+
+ActionRecord SimulateStep::toRecord() const {
+    return makeRecord(ActionKind::STEP, getStatus(), numOfSteps);
 }
 
 SimulateStep *SimulateStep::clone() const {
@@ -54,24 +70,25 @@ AddPlan::AddPlan(const std::string &settlementName, const std::string &selection
     : settlementName(settlementName), selectionPolicy(selectionPolicy) {}
 
 void AddPlan::act(Simulation &simulation) {
-    if (simulation.isSettlementExists(settlementName)) {
-        if (selectionPolicy == "nve") {
-            simulation.addPlan(simulation.getSettlement(settlementName), new NaiveSelection());
-        } else if (selectionPolicy == "bal") {
-            simulation.addPlan(simulation.getSettlement(settlementName), new BalancedSelection(0, 0, 0));
-        } else if (selectionPolicy == "eco") {
-            simulation.addPlan(simulation.getSettlement(settlementName), new EconomySelection());
-        } else {
-            simulation.addPlan(simulation.getSettlement(settlementName), new SustainabilitySelection());
-        }
-        complete();
-    } else {
+    if (!simulation.isSettlementExists(settlementName)) {
         error("Settlement " + settlementName + " does not exist.");
+        return;
     }
+    SelectionPolicy *policy = simulation.createPolicy(selectionPolicy);
+    if (policy == nullptr) {
+        error("Unknown selection policy " + selectionPolicy + ".");
+        return;
+    }
+    simulation.addPlan(simulation.getSettlementIndex(settlementName), policy);
+    complete();
 }
 
 const std::string AddPlan::toString() const {
-    return "AddPlan: Added plan to settlement " + settlementName + " with policy " + selectionPolicy;
+    return describe(ActionKind::ADD_PLAN, 0, settlementName, selectionPolicy);
+}
+
+ActionRecord AddPlan::toRecord() const {
+    return makeRecord(ActionKind::ADD_PLAN, getStatus(), 0, NameTable::intern(settlementName), NameTable::intern(selectionPolicy));
 }
 
 AddPlan *AddPlan::clone() const {
@@ -92,18 +109,11 @@ AddSettlement *AddSettlement::clone() const {
 }
 
 const std::string AddSettlement::toString() const {
-    string type = "";
+    return describe(ActionKind::ADD_SETTLEMENT, static_cast<int>(settlementType), settlementName);
+}
 
-    // Add the type to the stringstream
-    if (settlementType == SettlementType::VILLAGE) {
-        type = "0";
-    } else if (settlementType == SettlementType::CITY) {
-        type = "1";
-    } else {
-        type = "2";
-    }
-    string toString = "settlement " + settlementName + " " + type;
-    return toString;
+ActionRecord AddSettlement::toRecord() const {
+    return makeRecord(ActionKind::ADD_SETTLEMENT, getStatus(), static_cast<int>(settlementType), NameTable::intern(settlementName));
 }
 
 // AddFacility Implementation
@@ -129,7 +139,11 @@ AddFacility *AddFacility::clone() const {
 }
 
 const std::string AddFacility::toString() const {
-    return "AddFacility: Added facility " + facilityName;
+    return describe(ActionKind::ADD_FACILITY, 0, facilityName);
+}
+
+ActionRecord AddFacility::toRecord() const {
+    return makeRecord(ActionKind::ADD_FACILITY, getStatus(), 0, NameTable::intern(facilityName));
 }
 
 
@@ -138,7 +152,7 @@ const std::string AddFacility::toString() const {
 PrintPlanStatus::PrintPlanStatus(int planId) : planId(planId) {}
 
 void PrintPlanStatus::act(Simulation &simulation) {
-    simulation.getPlan(planId).printStatus();
+    simulation.getPlan(planId).printStatus(simulation.getFacilityCatalog());
     complete();
 }
 
@@ -147,7 +161,11 @@ PrintPlanStatus *PrintPlanStatus::clone() const {
 }
 
 const std::string PrintPlanStatus::toString() const {
-    return "planStatus " + std::to_string(planId);
+    return describe(ActionKind::PLAN_STATUS, planId);
+}
+
+ActionRecord PrintPlanStatus::toRecord() const {
+    return makeRecord(ActionKind::PLAN_STATUS, getStatus(), planId);
 }
 
 
@@ -162,20 +180,13 @@ void ChangePlanPolicy::act(Simulation &simulation) {
         error("illegal input");
     }
     oldPolicy = p.getSelectionPolicy()->toString();
-    try {
-        if (newPolicy == "nve") {
-            p.setSelectionPolicy(new NaiveSelection());
-        } else if (newPolicy == "bal") {
-            p.setSelectionPolicy(new BalancedSelection(p.getlifeQualityScore(),p.getEconomyScore(),p.getEnvironmentScore()));
-        } else if (newPolicy == "eco") {
-            p.setSelectionPolicy(new EconomySelection());
-        } else {
-            p.setSelectionPolicy(new SustainabilitySelection());
-        }
-        complete();
-    } catch (const std::exception &e) {
-        error(e.what());
+    SelectionPolicy *policy = simulation.createPolicy(newPolicy, p.getlifeQualityScore(), p.getEconomyScore(), p.getEnvironmentScore());
+    if (policy == nullptr) {
+        error("Unknown selection policy " + newPolicy + ".");
+        return;
     }
+    p.setSelectionPolicy(policy);
+    complete();
 }
 
 ChangePlanPolicy *ChangePlanPolicy::clone() const {
@@ -183,42 +194,111 @@ ChangePlanPolicy *ChangePlanPolicy::clone() const {
 }
 
 const std::string ChangePlanPolicy::toString() const {
-    std::ostringstream result;
-    result << "PlanID: " << planId<< "\n";
-    result << "previousPolicy: " << oldPolicy << "\n";
-    result << "newPolicy: " << newPolicy << "\n";
-    return result.str();
+    return describe(ActionKind::CHANGE_POLICY, planId, oldPolicy, newPolicy);
+}
+
+ActionRecord ChangePlanPolicy::toRecord() const {
+    return makeRecord(ActionKind::CHANGE_POLICY, getStatus(), planId, NameTable::intern(oldPolicy), NameTable::intern(newPolicy));
 }
 
 // PrintActionsLog Implementation
-PrintActionsLog::PrintActionsLog() {}
+PrintActionsLog::PrintActionsLog() : from(0), to(SIZE_MAX), fromEnd(false) {}
+
+PrintActionsLog::PrintActionsLog(size_t from, size_t to) : from(from), to(to), fromEnd(false) {}
+
+PrintActionsLog::PrintActionsLog(size_t from, size_t to, bool fromEnd) : from(from), to(to), fromEnd(fromEnd) {}
+
+PrintActionsLog PrintActionsLog::tail(size_t count) {
+    return PrintActionsLog(0, count, true);
+}
 
 void PrintActionsLog::act(Simulation &simulation) {
-    // Retrieve the list of actions from the simulation
-    const auto &actionsLog = simulation.getActionsLog();
-
-    // Iterate through the actions log and print each action
-    for (const BaseAction *action : actionsLog) {
-        std::cout << action->toString() << " ";
-        
-        // Print the status of the action
-        if (action->getStatus() == ActionStatus::COMPLETED) {
-            std::cout << "COMPLETED";
-        } else {
-            std::cout << "ERROR";
-        }
-        
-        std::cout << std::endl;
+    const ActionLog &log = simulation.getActionsLog();
+    if (fromEnd) {
+        log.print(std::cout, log.size() - std::min(log.size(), to), log.size());
+    } else {
+        log.print(std::cout, from, to);
     }
-    complete(); // Mark this action as completed
+    complete();
 }
 
 PrintActionsLog *PrintActionsLog::clone() const {
     return new PrintActionsLog(*this);
 }
 
+string PrintActionsLog::firstWord() const {
+    if (fromEnd) {
+        return "tail";
+    }
+    return to == SIZE_MAX ? "" : std::to_string(from);
+}
+
 const std::string PrintActionsLog::toString() const {
-    return "PrintActionsLog: Printed actions log.";
+    return describe(ActionKind::PRINT_LOG, to == SIZE_MAX ? 0 : static_cast<int>(to), firstWord());
+}
+
+ActionRecord PrintActionsLog::toRecord() const {
+    string first = firstWord();
+    return makeRecord(ActionKind::PRINT_LOG, getStatus(), to == SIZE_MAX ? 0 : static_cast<int>(to),
+        first.empty() ? NameTable::NONE : NameTable::intern(first));
+}
+
+// PrintLeaderboard Implementation
+PrintLeaderboard::PrintLeaderboard(int count, Leaderboard::Metric metric) : count(count), metric(metric) {}
+
+void PrintLeaderboard::act(Simulation &simulation) {
+    vector<size_t> positions;
+    simulation.topPlans(metric, static_cast<size_t>(count), positions);
+    const vector<Plan> &plans = simulation.getPlans();
+    for (size_t position : positions) {
+        std::cout << plans[position].shortenedToString() << '\n';
+    }
+    complete();
+}
+
+PrintLeaderboard *PrintLeaderboard::clone() const {
+    return new PrintLeaderboard(*this);
+}
+
+const std::string PrintLeaderboard::toString() const {
+    return describe(ActionKind::TOP, count, Leaderboard::metricName(metric));
+}
+
+ActionRecord PrintLeaderboard::toRecord() const {
+    return makeRecord(ActionKind::TOP, getStatus(), count, NameTable::intern(Leaderboard::metricName(metric)));
+}
+
+// PrintStats Implementation
+PrintStats::PrintStats(const string &settlementName) : settlementName(settlementName) {}
+
+void PrintStats::act(Simulation &simulation) {
+    const PlanStats &stats = simulation.getPlanStats();
+    PlanTotals totals = stats.total();
+    if (!settlementName.empty()) {
+        totals = stats.settlementTotal(simulation.getSettlementIndex(settlementName));
+        std::cout << "SettlementName: " << settlementName << "\n";
+    }
+    std::cout << "Plans: " << totals.plans << "\n";
+    std::cout << "BusyPlans: " << totals.busyPlans << "\n";
+    std::cout << "AvailablePlans: " << totals.plans - totals.busyPlans << "\n";
+    std::cout << "OperationalFacilities: " << totals.operationalFacilities << "\n";
+    std::cout << "UnderConstructionFacilities: " << totals.underConstructionFacilities << "\n";
+    std::cout << "LifeQualityScore: " << totals.lifeQualityScore << "\n";
+    std::cout << "EconomyScore: " << totals.economyScore << "\n";
+    std::cout << "EnvironmentScore: " << totals.environmentScore << "\n";
+    complete();
+}
+
+PrintStats *PrintStats::clone() const {
+    return new PrintStats(*this);
+}
+
+const std::string PrintStats::toString() const {
+    return describe(ActionKind::STATS, 0, settlementName);
+}
+
+ActionRecord PrintStats::toRecord() const {
+    return makeRecord(ActionKind::STATS, getStatus(), 0, settlementName.empty() ? NameTable::NONE : NameTable::intern(settlementName));
 }
 
 // Close Implementation
@@ -234,14 +314,24 @@ Close *Close::clone() const {
 }
 
 const std::string Close::toString() const {
-    return "Close: Closed the simulation.";
+    return describe(ActionKind::CLOSE, 0);
+}
+
+ActionRecord Close::toRecord() const {
+    return makeRecord(ActionKind::CLOSE, getStatus(), 0);
 }
 
 // BackupSimulation Implementation
-BackupSimulation::BackupSimulation() {}
+BackupSimulation::BackupSimulation() : name() {}
+
+BackupSimulation::BackupSimulation(const std::string &name) : name(name) {}
 
 void BackupSimulation::act(Simulation &simulation) {
-    simulation.backUp();
+    if (name.empty()) {
+        simulation.backUp();
+    } else {
+        simulation.backUp(name);
+    }
     complete();
 }
 
@@ -250,14 +340,24 @@ BackupSimulation *BackupSimulation::clone() const {
 }
 
 const std::string BackupSimulation::toString() const {
-    return "backup";
+    return describe(ActionKind::BACKUP, 0, name);
+}
+
+ActionRecord BackupSimulation::toRecord() const {
+    return makeRecord(ActionKind::BACKUP, getStatus(), 0, name.empty() ? NameTable::NONE : NameTable::intern(name));
 }
 
 // RestoreSimulation Implementation
-RestoreSimulation::RestoreSimulation() {}
+RestoreSimulation::RestoreSimulation() : name() {}
+
+RestoreSimulation::RestoreSimulation(const std::string &name) : name(name) {}
 
 void RestoreSimulation::act(Simulation &simulation) {
-    simulation.restore();
+    if (name.empty()) {
+        simulation.restore();
+    } else {
+        simulation.restore(name);
+    }
     complete();
 }
 
@@ -266,5 +366,49 @@ RestoreSimulation *RestoreSimulation::clone() const {
 }
 
 const std::string RestoreSimulation::toString() const {
-    return "RestoreSimulation: Restored from backup.";
+    return describe(ActionKind::RESTORE, 0, name);
+}
+
+ActionRecord RestoreSimulation::toRecord() const {
+    return makeRecord(ActionKind::RESTORE, getStatus(), 0, name.empty() ? NameTable::NONE : NameTable::intern(name));
+}
+
+// SaveCheckpoint Implementation
+SaveCheckpoint::SaveCheckpoint(const std::string &path) : path(path) {}
+
+void SaveCheckpoint::act(Simulation &simulation) {
+    simulation.saveCheckpoint(path);
+    complete();
+}
+
+SaveCheckpoint *SaveCheckpoint::clone() const {
+    return new SaveCheckpoint(*this);
+}
+
+const std::string SaveCheckpoint::toString() const {
+    return describe(ActionKind::SAVE, 0, path);
+}
+
+ActionRecord SaveCheckpoint::toRecord() const {
+    return makeRecord(ActionKind::SAVE, getStatus(), 0, NameTable::intern(path));
+}
+
+// LoadCheckpoint Implementation
+LoadCheckpoint::LoadCheckpoint(const std::string &path) : path(path) {}
+
+void LoadCheckpoint::act(Simulation &simulation) {
+    simulation.loadCheckpoint(path);
+    complete();
+}
+
+LoadCheckpoint *LoadCheckpoint::clone() const {
+    return new LoadCheckpoint(*this);
+}
+
+const std::string LoadCheckpoint::toString() const {
+    return describe(ActionKind::LOAD, 0, path);
+}
+
+ActionRecord LoadCheckpoint::toRecord() const {
+    return makeRecord(ActionKind::LOAD, getStatus(), 0, NameTable::intern(path));
 }
@@ -0,0 +1,228 @@
+#include "ActionLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+const size_t ActionLog::CHUNK_SIZE;
+
+ActionLog::ActionLog()
+    : records(), extents(std::make_shared<vector<Extent>>()), spilled(0), capacity(0), file() {}
+
+void ActionLog::spillTo(const string &path, size_t capacity) {
+    file = std::make_shared<SpillFile>(path);
+    this->capacity = capacity;
+    while (records.size() >= capacity + CHUNK_SIZE && records.chunkCount() > 1) {
+        spillOldestChunk();
+    }
+}
+
+void ActionLog::spillLike(const ActionLog &other) {
+    file = other.file;
+    capacity = other.capacity;
+}
+
+size_t ActionLog::size() const {
+    return spilled + records.size();
+}
+
+bool ActionLog::empty() const {
+    return size() == 0;
+}
+
+void ActionLog::append(const ActionRecord &record) {
+    records.push_back(record);
+    if (file && records.size() >= capacity + CHUNK_SIZE && records.chunkCount() > 1) {
+        spillOldestChunk();
+    }
+}
+
+void ActionLog::spillOldestChunk() {
+    size_t count;
+    const ActionRecord *chunk = records.chunkData(0, count);
+    uint64_t first = file->write(chunk, count);
+    if (extents.use_count() > 1) {
+        extents = std::make_shared<vector<Extent>>(*extents);
+    }
+    if (!extents->empty() && extents->back().first + extents->back().count == first) {
+        extents->back().count += count;
+    } else {
+        Extent extent = {first, count};
+        extents->push_back(extent);
+    }
+    spilled += count;
+    records.popFrontChunk();
+}
+
+void ActionLog::clear() {
+    records.clear();
+    extents = std::make_shared<vector<Extent>>();
+    spilled = 0;
+}
+
+void ActionLog::print(std::ostream &out, size_t from, size_t to) const {
+    // Lines are gathered into one buffer and written out in blocks
+    string buffer;
+    visit(from, to, [this, &out, &buffer](const ActionRecord *block, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            describe(block[i], buffer);
+            buffer += block[i].status == ActionStatus::COMPLETED ? " COMPLETED\n" : " ERROR\n";
+            if (buffer.size() >= (1 << 16)) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+    });
+    out.write(buffer.data(), buffer.size());
+}
+
+void ActionLog::describe(const ActionRecord &record, string &out) const {
+    describe(record.kind, record.value, NameTable::name(record.text[0]), NameTable::name(record.text[1]), out);
+}
+
+void ActionLog::describe(ActionKind kind, int value, const string &first, const string &second, string &out) {
+    switch (kind) {
+        case ActionKind::STEP:
+            out += "step ";
+            out += std::to_string(value);
+            break;
+        case ActionKind::ADD_PLAN:
+            out += "AddPlan: Added plan to settlement ";
+            out += first;
+            out += " with policy ";
+            out += second;
+            break;
+        case ActionKind::ADD_SETTLEMENT:
+            out += "settlement ";
+            out += first;
+            out += value == 0 ? " 0" : value == 1 ? " 1" : " 2";
+            break;
+        case ActionKind::ADD_FACILITY:
+            out += "AddFacility: Added facility ";
+            out += first;
+            break;
+        case ActionKind::PLAN_STATUS:
+            out += "planStatus ";
+            out += std::to_string(value);
+            break;
+        case ActionKind::CHANGE_POLICY:
+            out += "PlanID: ";
+            out += std::to_string(value);
+            out += "\npreviousPolicy: ";
+            out += first;
+            out += "\nnewPolicy: ";
+            out += second;
+            out += "\n";
+            break;
+        case ActionKind::PRINT_LOG:
+            out += first.empty() ? "PrintActionsLog: Printed actions log." : "log " + first + " " + std::to_string(value);
+            break;
+        case ActionKind::CLOSE:
+            out += "Close: Closed the simulation.";
+            break;
+        case ActionKind::BACKUP:
+            out += first.empty() ? "backup" : "backup " + first;
+            break;
+        case ActionKind::RESTORE:
+            out += first.empty() ? "RestoreSimulation: Restored from backup." :
+                "RestoreSimulation: Restored from backup " + first + ".";
+            break;
+        case ActionKind::SAVE:
+            out += "save ";
+            out += first;
+            break;
+        case ActionKind::LOAD:
+            out += "load ";
+            out += first;
+            break;
+        case ActionKind::TOP:
+            out += "top ";
+            out += std::to_string(value);
+            out += " ";
+            out += first;
+            break;
+        case ActionKind::STATS:
+            out += first.empty() ? "stats" : "stats " + first;
+            break;
+        default:
+            break;
+    }
+}
+
+void ActionLog::visit(size_t from, size_t to,
+                      const std::function<void(const ActionRecord *records, size_t count)> &visitor) const {
+    to = std::min(to, size());
+    size_t index = 0; // Of the first record of the extent or chunk at hand
+    vector<ActionRecord> buffer;
+    for (const Extent &extent : *extents) {
+        size_t end = std::min<size_t>(to, index + extent.count);
+        for (size_t begin = std::max(from, index); begin < end; begin += CHUNK_SIZE) {
+            size_t count = std::min(CHUNK_SIZE, end - begin);
+            buffer.resize(count);
+            file->read(extent.first + (begin - index), count, buffer.data());
+            visitor(buffer.data(), count);
+        }
+        index += extent.count;
+    }
+    for (size_t chunk = 0; chunk < records.chunkCount() && index < to; chunk++) {
+        size_t count;
+        const ActionRecord *data = records.chunkData(chunk, count);
+        size_t begin = std::max(from, index);
+        size_t end = std::min(to, index + count);
+        if (begin < end) {
+            visitor(data + (begin - index), end - begin);
+        }
+        index += count;
+    }
+}
+
+ActionLog::SpillFile::SpillFile(const string &path) : path(path), fd(-1), written(0) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open actions log file: " + path);
+    }
+}
+
+ActionLog::SpillFile::~SpillFile() {
+    close(fd);
+}
+
+uint64_t ActionLog::SpillFile::write(const ActionRecord *records, size_t count) {
+    const char *bytes = reinterpret_cast<const char *>(records);
+    size_t size = count * sizeof(ActionRecord);
+    off_t offset = static_cast<off_t>(written * sizeof(ActionRecord));
+    while (size > 0) {
+        ssize_t done = pwrite(fd, bytes, size, offset);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            throw std::runtime_error("Could not write actions log file: " + path);
+        }
+        bytes += done;
+        size -= static_cast<size_t>(done);
+        offset += done;
+    }
+    uint64_t first = written;
+    written += count;
+    return first;
+}
+
+void ActionLog::SpillFile::read(uint64_t first, size_t count, ActionRecord *records) const {
+    char *bytes = reinterpret_cast<char *>(records);
+    size_t size = count * sizeof(ActionRecord);
+    off_t offset = static_cast<off_t>(first * sizeof(ActionRecord));
+    while (size > 0) {
+        ssize_t done = pread(fd, bytes, size, offset);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            throw std::runtime_error("Could not read actions log file: " + path);
+        }
+        bytes += done;
+        size -= static_cast<size_t>(done);
+        offset += done;
+    }
+}
@@ -0,0 +1,111 @@
+#include "BalancedIndex.h"
+#include "FacilityCatalog.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+    // Distance from 0 to the nearest value in [low, high]
+    long long distanceToZero(long long low, long long high) {
+        return low > 0 ? low : high < 0 ? -high : 0;
+    }
+}
+
+BalancedIndex::BalancedIndex(const FacilityCatalog &catalog) : points(), nodes() {
+    points.reserve(catalog.size());
+    for (size_t i = 0; i < catalog.size(); i++) {
+        long long lifeQuality = catalog.lifeQualityScores()[i];
+        Point point = {lifeQuality - catalog.environmentScores()[i], lifeQuality - catalog.economyScores()[i], i};
+        points.push_back(point);
+    }
+    if (!points.empty()) {
+        nodes.reserve(2 * points.size() / LEAF_SIZE + 1);
+        build(0, points.size());
+    }
+}
+
+// Splits [begin, end) at the median of its wider axis
+int BalancedIndex::build(size_t begin, size_t end) {
+    Node node = {LLONG_MAX, LLONG_MIN, LLONG_MAX, LLONG_MIN, SIZE_MAX, begin, end, -1, -1};
+    for (size_t i = begin; i < end; i++) {
+        node.minX = std::min(node.minX, points[i].x);
+        node.maxX = std::max(node.maxX, points[i].x);
+        node.minY = std::min(node.minY, points[i].y);
+        node.maxY = std::max(node.maxY, points[i].y);
+        node.minIndex = std::min(node.minIndex, points[i].index);
+    }
+    int id = static_cast<int>(nodes.size());
+    nodes.push_back(node);
+    if (end - begin <= LEAF_SIZE) {
+        return id;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    if (node.maxX - node.minX >= node.maxY - node.minY) {
+        std::nth_element(points.begin() + begin, points.begin() + middle, points.begin() + end,
+            [](const Point &p, const Point &q) { return p.x < q.x; });
+    } else {
+        std::nth_element(points.begin() + begin, points.begin() + middle, points.begin() + end,
+            [](const Point &p, const Point &q) { return p.y < q.y; });
+    }
+    int left = build(begin, middle);
+    int right = build(middle, end);
+    nodes[id].left = left;
+    nodes[id].right = right;
+    return id;
+}
+
+// No point in the node's box is nearer than this
+long long BalancedIndex::lowerBound(const Node &node, long long a, long long b) const {
+    long long u = distanceToZero(node.minX + a, node.maxX + a);
+    long long v = distanceToZero(node.minY + b, node.maxY + b);
+    long long w = distanceToZero(node.minY + b - node.maxX - a, node.maxY + b - node.minX - a);
+    return std::max(u, std::max(v, w));
+}
+
+size_t BalancedIndex::findBest(int lifeQuality, int economy, int environment) const {
+    long long a = static_cast<long long>(lifeQuality) - environment;
+    long long b = static_cast<long long>(lifeQuality) - economy;
+    // Like the scan, only a gap below INT_MAX counts
+    long long bestGap = INT_MAX;
+    size_t bestIndex = SIZE_MAX;
+    if (nodes.empty()) {
+        return bestIndex;
+    }
+
+    int stack[128];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const Node &node = nodes[stack[--depth]];
+        long long bound = lowerBound(node, a, b);
+        if (bound > bestGap || (bound == bestGap && node.minIndex > bestIndex)) {
+            continue;
+        }
+        if (node.left < 0) {
+            for (size_t i = node.begin; i < node.end; i++) {
+                const Point &point = points[i];
+                long long u = point.x + a;
+                long long v = point.y + b;
+                long long gap = std::max(std::llabs(u), std::max(std::llabs(v), std::llabs(v - u)));
+                if (gap < bestGap || (gap == bestGap && point.index < bestIndex && bestIndex != SIZE_MAX)) {
+                    bestGap = gap;
+                    bestIndex = point.index;
+                }
+            }
+            continue;
+        }
+        // The nearer child is searched first, so it is pushed last
+        const Node &left = nodes[node.left];
+        const Node &right = nodes[node.right];
+        if (lowerBound(left, a, b) <= lowerBound(right, a, b)) {
+            stack[depth++] = node.right;
+            stack[depth++] = node.left;
+        } else {
+            stack[depth++] = node.left;
+            stack[depth++] = node.right;
+        }
+    }
+    return bestIndex;
+}
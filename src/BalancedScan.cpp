@@ -0,0 +1,155 @@
+#include "BalancedScan.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BALANCED_SCAN_X86
+#endif
+
+namespace {
+
+// The scores of the types, and the plan's scores added to each of them
+struct ScanInput {
+    const int *lifeQuality;
+    const int *economy;
+    const int *environment;
+    size_t count;
+    int planLifeQuality;
+    int planEconomy;
+    int planEnvironment;
+};
+
+// The first type with the smallest gap among types [from, count), unless a
+// type before from already had a smaller or equal one
+void scanScalar(const ScanInput &in, size_t from, int &bestScore, size_t &bestIndex) {
+    for (size_t i = from; i < in.count; i++) {
+        int lifeQuality = in.lifeQuality[i] + in.planLifeQuality;
+        int economy = in.economy[i] + in.planEconomy;
+        int environment = in.environment[i] + in.planEnvironment;
+        int gap = std::max(std::abs(lifeQuality - environment),
+                           std::max(std::abs(lifeQuality - economy), std::abs(environment - economy)));
+        if (gap < bestScore) {
+            bestScore = gap;
+            bestIndex = i;
+        }
+    }
+}
+
+// Every lane keeps the first smallest gap among the types it saw; the lanes
+// are merged by (gap, index), which keeps the first smallest over all types
+void mergeLanes(const int *scores, const int *indices, int lanes, int &bestScore, size_t &bestIndex) {
+    for (int lane = 0; lane < lanes; lane++) {
+        if (indices[lane] < 0) {
+            continue;
+        }
+        size_t index = static_cast<size_t>(indices[lane]);
+        if (scores[lane] < bestScore || (scores[lane] == bestScore && index < bestIndex)) {
+            bestScore = scores[lane];
+            bestIndex = index;
+        }
+    }
+}
+
+#ifdef BALANCED_SCAN_X86
+__attribute__((target("avx2")))
+size_t scanAvx2(const ScanInput &in, int &bestScore, size_t &bestIndex) {
+    const __m256i planLifeQuality = _mm256_set1_epi32(in.planLifeQuality);
+    const __m256i planEconomy = _mm256_set1_epi32(in.planEconomy);
+    const __m256i planEnvironment = _mm256_set1_epi32(in.planEnvironment);
+    const __m256i stride = _mm256_set1_epi32(8);
+    __m256i best = _mm256_set1_epi32(INT_MAX);
+    __m256i bestIndices = _mm256_set1_epi32(-1);
+    __m256i indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t i = 0;
+    for (; i + 8 <= in.count; i += 8) {
+        __m256i lifeQuality = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in.lifeQuality + i)), planLifeQuality);
+        __m256i economy = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in.economy + i)), planEconomy);
+        __m256i environment = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in.environment + i)), planEnvironment);
+        __m256i gap = _mm256_max_epi32(_mm256_abs_epi32(_mm256_sub_epi32(lifeQuality, environment)),
+                      _mm256_max_epi32(_mm256_abs_epi32(_mm256_sub_epi32(lifeQuality, economy)),
+                                       _mm256_abs_epi32(_mm256_sub_epi32(environment, economy))));
+        __m256i better = _mm256_cmpgt_epi32(best, gap);
+        best = _mm256_blendv_epi8(best, gap, better);
+        bestIndices = _mm256_blendv_epi8(bestIndices, indices, better);
+        indices = _mm256_add_epi32(indices, stride);
+    }
+    int32_t scores[8], laneIndices[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(scores), best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(laneIndices), bestIndices);
+    mergeLanes(scores, laneIndices, 8, bestScore, bestIndex);
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+size_t scanSse41(const ScanInput &in, int &bestScore, size_t &bestIndex) {
+    const __m128i planLifeQuality = _mm_set1_epi32(in.planLifeQuality);
+    const __m128i planEconomy = _mm_set1_epi32(in.planEconomy);
+    const __m128i planEnvironment = _mm_set1_epi32(in.planEnvironment);
+    const __m128i stride = _mm_set1_epi32(4);
+    __m128i best = _mm_set1_epi32(INT_MAX);
+    __m128i bestIndices = _mm_set1_epi32(-1);
+    __m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+    size_t i = 0;
+    for (; i + 4 <= in.count; i += 4) {
+        __m128i lifeQuality = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in.lifeQuality + i)), planLifeQuality);
+        __m128i economy = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in.economy + i)), planEconomy);
+        __m128i environment = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in.environment + i)), planEnvironment);
+        __m128i gap = _mm_max_epi32(_mm_abs_epi32(_mm_sub_epi32(lifeQuality, environment)),
+                      _mm_max_epi32(_mm_abs_epi32(_mm_sub_epi32(lifeQuality, economy)),
+                                    _mm_abs_epi32(_mm_sub_epi32(environment, economy))));
+        __m128i better = _mm_cmpgt_epi32(best, gap);
+        best = _mm_blendv_epi8(best, gap, better);
+        bestIndices = _mm_blendv_epi8(bestIndices, indices, better);
+        indices = _mm_add_epi32(indices, stride);
+    }
+    int32_t scores[4], laneIndices[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(scores), best);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(laneIndices), bestIndices);
+    mergeLanes(scores, laneIndices, 4, bestScore, bestIndex);
+    return i;
+}
+#endif
+
+BalancedScan::Kernel detectKernel() {
+#ifdef BALANCED_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return BalancedScan::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return BalancedScan::SSE41;
+    }
+#endif
+    return BalancedScan::SCALAR;
+}
+
+} // namespace
+
+size_t BalancedScan::findBest(const FacilityCatalog &catalog, int lifeQuality, int economy, int environment) {
+    return findBest(catalog, lifeQuality, economy, environment, bestKernel());
+}
+
+size_t BalancedScan::findBest(const FacilityCatalog &catalog, int lifeQuality, int economy, int environment, Kernel kernel) {
+    ScanInput in = {catalog.lifeQualityScores(), catalog.economyScores(), catalog.environmentScores(),
+                    catalog.size(), lifeQuality, economy, environment};
+    int bestScore = INT_MAX;
+    size_t bestIndex = SIZE_MAX;
+    size_t scanned = 0;
+#ifdef BALANCED_SCAN_X86
+    if (kernel == AVX2) {
+        scanned = scanAvx2(in, bestScore, bestIndex);
+    } else if (kernel == SSE41) {
+        scanned = scanSse41(in, bestScore, bestIndex);
+    }
+#endif
+    // The types left over after the last full vector
+    scanScalar(in, scanned, bestScore, bestIndex);
+    return bestIndex;
+}
+
+BalancedScan::Kernel BalancedScan::bestKernel() {
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
@@ -0,0 +1,401 @@
+#include "Checkpoint.h"
+#include "Action.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const char MAGIC[8] = {'C', 'B', 'S', 'C', 'K', 'P', 'T', '\0'};
+
+enum Section {
+    STRINGS,
+    SETTLEMENTS,
+    FACILITIES,
+    PLANS,
+    POLICY_STATE,
+    OPERATIONAL,
+    CONSTRUCTION,
+    ACTIONS,
+    ACTION_TEXTS,
+    SECTION_COUNT,
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    int32_t planCounter;
+    uint64_t offsets[SECTION_COUNT];
+    uint64_t counts[SECTION_COUNT];
+};
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SettlementRecord {
+    StringRef name;
+    int32_t type;
+    int32_t padding;
+};
+
+struct FacilityRecord {
+    StringRef name;
+    int32_t category, price, lifeQuality, economy, environment, padding;
+};
+
+struct PlanRecord {
+    int32_t id, settlement, status, lifeQuality, economy, environment;
+    StringRef policy;
+    uint64_t policyStateBegin, operationalBegin, operationalCount;
+    int64_t clock;
+    uint32_t policyStateCount, constructionBegin, constructionCount, padding;
+};
+
+struct ConstructionRecord {
+    int32_t type;
+    int32_t timeLeft;
+};
+
+const size_t RECORD_SIZES[SECTION_COUNT] = {
+    sizeof(char), sizeof(SettlementRecord), sizeof(FacilityRecord), sizeof(PlanRecord),
+    sizeof(int64_t), sizeof(int32_t), sizeof(ConstructionRecord), sizeof(ActionRecord), sizeof(StringRef),
+};
+
+// Collects the sections of a checkpoint before they are written out
+class CheckpointWriter {
+    public:
+        CheckpointWriter() : sections(SECTION_COUNT), counts(SECTION_COUNT, 0), strings() {}
+
+        template <typename T>
+        void add(Section section, const T &record) {
+            const char *bytes = reinterpret_cast<const char *>(&record);
+            sections[section].insert(sections[section].end(), bytes, bytes + sizeof(T));
+            counts[section]++;
+        }
+
+        template <typename T>
+        void addAll(Section section, const T *records, size_t count) {
+            const char *bytes = reinterpret_cast<const char *>(records);
+            sections[section].insert(sections[section].end(), bytes, bytes + count * sizeof(T));
+            counts[section] += count;
+        }
+
+        // Every distinct string is stored once
+        StringRef addString(const string &value) {
+            auto found = strings.find(value);
+            if (found != strings.end()) {
+                return found->second;
+            }
+            StringRef ref = {static_cast<uint32_t>(sections[STRINGS].size()), static_cast<uint32_t>(value.size())};
+            sections[STRINGS].insert(sections[STRINGS].end(), value.begin(), value.end());
+            counts[STRINGS] += value.size();
+            strings[value] = ref;
+            return ref;
+        }
+
+        uint64_t count(Section section) const {
+            return counts[section];
+        }
+
+        void write(const string &path, int32_t planCounter) {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = Checkpoint::FORMAT_VERSION;
+            header.planCounter = planCounter;
+            uint64_t offset = sizeof(Header);
+            for (int section = 0; section < SECTION_COUNT; section++) {
+                header.offsets[section] = offset;
+                header.counts[section] = counts[section];
+                offset += padded(sections[section].size());
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Could not open checkpoint file: " + path);
+            }
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            const char zeros[8] = {0};
+            for (const vector<char> &section : sections) {
+                file.write(section.data(), section.size());
+                file.write(zeros, padded(section.size()) - section.size());
+            }
+            if (!file) {
+                throw std::runtime_error("Could not write checkpoint file: " + path);
+            }
+        }
+
+    private:
+        static uint64_t padded(uint64_t size) {
+            return (size + 7) & ~static_cast<uint64_t>(7);
+        }
+
+        vector<vector<char>> sections;
+        vector<uint64_t> counts;
+        std::unordered_map<string, StringRef> strings;
+};
+
+// A read-only mapping of a checkpoint file, released when it goes out of scope
+class MappedCheckpoint {
+    public:
+        MappedCheckpoint(const string &path) : file(path), data(file.data()), size(file.size()) {
+            if (!file.isOpen()) {
+                throw std::runtime_error("Could not open checkpoint file: " + path);
+            }
+            if (size < sizeof(Header)) {
+                throw std::runtime_error("Not a checkpoint file: " + path);
+            }
+        }
+
+        MappedCheckpoint(const MappedCheckpoint &other) = delete;
+        MappedCheckpoint &operator=(const MappedCheckpoint &other) = delete;
+
+        // Checks the header and that every section lies inside the file
+        void validate(const string &path) const {
+            const Header &header = getHeader();
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("Not a checkpoint file: " + path);
+            }
+            if (header.version != Checkpoint::FORMAT_VERSION) {
+                throw std::runtime_error("Unsupported checkpoint version: " + std::to_string(header.version));
+            }
+            for (int section = 0; section < SECTION_COUNT; section++) {
+                if (header.offsets[section] > size || header.offsets[section] % 8 != 0 ||
+                    header.counts[section] > (size - header.offsets[section]) / RECORD_SIZES[section]) {
+                    throw std::runtime_error("Corrupt checkpoint file: " + path);
+                }
+            }
+        }
+
+        const Header &getHeader() const {
+            return *reinterpret_cast<const Header *>(data);
+        }
+
+        template <typename T>
+        const T *records(Section section) const {
+            return reinterpret_cast<const T *>(data + getHeader().offsets[section]);
+        }
+
+        uint64_t count(Section section) const {
+            return getHeader().counts[section];
+        }
+
+        string getString(const StringRef &ref) const {
+            if (static_cast<uint64_t>(ref.offset) + ref.length > count(STRINGS)) {
+                throw std::runtime_error("Corrupt checkpoint: string out of range");
+            }
+            return string(records<char>(STRINGS) + ref.offset, ref.length);
+        }
+
+    private:
+        MappedFile file;
+        const char *data;
+        size_t size;
+};
+
+void check(bool condition) {
+    if (!condition) {
+        throw std::runtime_error("Corrupt checkpoint: record out of range");
+    }
+}
+
+} // namespace
+
+void Checkpoint::save(const Simulation &simulation, const string &path) {
+    CheckpointWriter writer;
+
+    for (const std::shared_ptr<Settlement> &settlement : simulation.settlements) {
+        SettlementRecord record = {writer.addString(settlement->getName()), static_cast<int32_t>(settlement->getType()), 0};
+        writer.add(SETTLEMENTS, record);
+    }
+
+    for (const FacilityType &facility : simulation.facilitiesOptions) {
+        FacilityRecord record = {writer.addString(facility.getName()), static_cast<int32_t>(facility.getCategory()),
+            facility.getCost(), facility.getLifeQualityScore(), facility.getEconomyScore(), facility.getEnvironmentScore(), 0};
+        writer.add(FACILITIES, record);
+    }
+
+    vector<long long> policyState;
+    for (const Plan &plan : simulation.plans) {
+        const FacilityStore &facilities = plan.getFacilities();
+        PlanRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = plan.getPlanID();
+        record.settlement = static_cast<int32_t>(plan.getSettlementIndex());
+        record.status = static_cast<int32_t>(plan.getStatus());
+        record.lifeQuality = plan.getlifeQualityScore();
+        record.economy = plan.getEconomyScore();
+        record.environment = plan.getEnvironmentScore();
+        record.policy = writer.addString(plan.getSelectionPolicy()->toString());
+        record.clock = facilities.getClock();
+
+        policyState.clear();
+        plan.getSelectionPolicy()->getState(policyState);
+        record.policyStateBegin = writer.count(POLICY_STATE);
+        record.policyStateCount = static_cast<uint32_t>(policyState.size());
+        for (long long value : policyState) {
+            writer.add(POLICY_STATE, static_cast<int64_t>(value));
+        }
+
+        record.operationalBegin = writer.count(OPERATIONAL);
+        record.operationalCount = facilities.operationalCount();
+        for (size_t i = 0; i < facilities.operationalCount(); i++) {
+            writer.add(OPERATIONAL, static_cast<int32_t>(facilities.getOperationalType(i)));
+        }
+
+        record.constructionBegin = static_cast<uint32_t>(writer.count(CONSTRUCTION));
+        record.constructionCount = static_cast<uint32_t>(facilities.underConstructionCount());
+        for (size_t i = 0; i < facilities.underConstructionCount(); i++) {
+            ConstructionRecord pending = {facilities.getUnderConstructionType(i), facilities.getTimeLeft(i)};
+            writer.add(CONSTRUCTION, pending);
+        }
+        writer.add(PLANS, record);
+    }
+
+    // Log records are written with their symbols renumbered densely, in
+    // order of first use, and the names of just those symbols. The name
+    // table also holds names this log never used (other simulations', old
+    // paths), which would otherwise pile up over save and load cycles.
+    const ActionLog &actionsLog = simulation.actionsLog;
+    std::unordered_map<Symbol, Symbol> saved;
+    vector<ActionRecord> block;
+    actionsLog.visit(0, actionsLog.size(), [&writer, &saved, &block](const ActionRecord *records, size_t count) {
+        block.assign(records, records + count);
+        for (ActionRecord &record : block) {
+            for (Symbol &text : record.text) {
+                if (text == NameTable::NONE) {
+                    continue;
+                }
+                auto found = saved.find(text);
+                if (found == saved.end()) {
+                    found = saved.insert(std::make_pair(text, static_cast<Symbol>(saved.size()))).first;
+                    writer.add(ACTION_TEXTS, writer.addString(NameTable::name(text)));
+                }
+                text = found->second;
+            }
+        }
+        writer.addAll(ACTIONS, block.data(), block.size());
+    });
+
+    writer.write(path, simulation.planCounter);
+}
+
+void Checkpoint::load(Simulation &simulation, const string &path) {
+    MappedCheckpoint file(path);
+    file.validate(path);
+
+    // Everything is rebuilt aside first, so a bad file leaves the simulation as it was
+    vector<std::shared_ptr<Settlement>> settlements;
+    const SettlementRecord *settlementRecords = file.records<SettlementRecord>(SETTLEMENTS);
+    for (uint64_t i = 0; i < file.count(SETTLEMENTS); i++) {
+        const SettlementRecord &record = settlementRecords[i];
+        check(record.type >= static_cast<int32_t>(SettlementType::VILLAGE) &&
+              record.type <= static_cast<int32_t>(SettlementType::METROPOLIS));
+        settlements.push_back(std::make_shared<Settlement>(file.getString(record.name), static_cast<SettlementType>(record.type)));
+    }
+
+    vector<FacilityType> facilities;
+    const FacilityRecord *facilityRecords = file.records<FacilityRecord>(FACILITIES);
+    for (uint64_t i = 0; i < file.count(FACILITIES); i++) {
+        const FacilityRecord &record = facilityRecords[i];
+        check(record.category >= static_cast<int32_t>(FacilityCategory::LIFE_QUALITY) &&
+              record.category <= static_cast<int32_t>(FacilityCategory::ENVIRONMENT));
+        facilities.push_back(FacilityType(file.getString(record.name), static_cast<FacilityCategory>(record.category),
+            record.price, record.lifeQuality, record.economy, record.environment));
+    }
+
+    const PlanRecord *planRecords = file.records<PlanRecord>(PLANS);
+    const int64_t *policyState = file.records<int64_t>(POLICY_STATE);
+    const int32_t *operational = file.records<int32_t>(OPERATIONAL);
+    const ConstructionRecord *construction = file.records<ConstructionRecord>(CONSTRUCTION);
+    vector<std::unique_ptr<SelectionPolicy>> policies;
+    vector<long long> state;
+    for (uint64_t i = 0; i < file.count(PLANS); i++) {
+        const PlanRecord &record = planRecords[i];
+        check(record.settlement >= 0 && static_cast<uint64_t>(record.settlement) < settlements.size());
+        check(record.status >= static_cast<int32_t>(PlanStatus::AVALIABLE) &&
+              record.status <= static_cast<int32_t>(PlanStatus::BUSY));
+        // Begin and count are both from the file, so their sum could wrap
+        check(record.policyStateCount <= file.count(POLICY_STATE) &&
+              record.policyStateBegin <= file.count(POLICY_STATE) - record.policyStateCount);
+        check(record.operationalCount <= file.count(OPERATIONAL) &&
+              record.operationalBegin <= file.count(OPERATIONAL) - record.operationalCount);
+        check(static_cast<uint64_t>(record.constructionBegin) + record.constructionCount <= file.count(CONSTRUCTION));
+        for (uint64_t j = 0; j < record.operationalCount; j++) {
+            check(operational[record.operationalBegin + j] >= 0 &&
+                  static_cast<uint64_t>(operational[record.operationalBegin + j]) < facilities.size());
+        }
+        for (uint32_t j = 0; j < record.constructionCount; j++) {
+            check(construction[record.constructionBegin + j].type >= 0 &&
+                  static_cast<uint64_t>(construction[record.constructionBegin + j].type) < facilities.size());
+        }
+        string policyName = file.getString(record.policy);
+        policies.push_back(std::unique_ptr<SelectionPolicy>(simulation.createPolicy(policyName)));
+        if (!policies.back()) {
+            throw std::runtime_error("Corrupt checkpoint: unknown selection policy " + policyName);
+        }
+        state.assign(policyState + record.policyStateBegin, policyState + record.policyStateBegin + record.policyStateCount);
+        check(policies.back()->acceptsState(state));
+        policies.back()->setState(state);
+    }
+
+    // Saved symbols are mapped to this process's symbols for the same names
+    ActionLog actionsLog;
+    actionsLog.spillLike(simulation.actionsLog);
+    const StringRef *texts = file.records<StringRef>(ACTION_TEXTS);
+    vector<Symbol> symbols;
+    for (uint64_t i = 0; i < file.count(ACTION_TEXTS); i++) {
+        symbols.push_back(NameTable::intern(file.getString(texts[i])));
+    }
+    const ActionRecord *actionRecords = file.records<ActionRecord>(ACTIONS);
+    for (uint64_t i = 0; i < file.count(ACTIONS); i++) {
+        ActionRecord record = actionRecords[i];
+        check(record.kind < ActionKind::KIND_COUNT && record.status <= ActionStatus::ERROR);
+        for (Symbol &text : record.text) {
+            check(text == NameTable::NONE || text < symbols.size());
+            if (text != NameTable::NONE) {
+                text = symbols[text];
+            }
+        }
+        actionsLog.append(record);
+    }
+
+    simulation.planCounter = file.getHeader().planCounter;
+    simulation.settlements = settlements;
+    simulation.facilitiesOptions.clear();
+    for (const FacilityType &facility : facilities) {
+        simulation.facilitiesOptions.push_back(facility);
+    }
+
+    simulation.plans.clear();
+    simulation.plans.reserve(file.count(PLANS));
+    for (uint64_t i = 0; i < file.count(PLANS); i++) {
+        const PlanRecord &record = planRecords[i];
+        SelectionPolicy *policy = policies[i].release();
+
+        FacilityStore store;
+        store.skipSteps(record.clock);
+        for (uint64_t j = 0; j < record.operationalCount; j++) {
+            store.addOperational(operational[record.operationalBegin + j]);
+        }
+        for (uint32_t j = 0; j < record.constructionCount; j++) {
+            const ConstructionRecord &pending = construction[record.constructionBegin + j];
+            store.addUnderConstruction(pending.type, pending.timeLeft);
+        }
+
+        simulation.plans.emplace_back(record.id, static_cast<size_t>(record.settlement), *settlements[record.settlement], policy);
+        Plan &plan = simulation.plans.back();
+        plan.setFacilities(store);
+        plan.setScores(record.lifeQuality, record.economy, record.environment);
+        plan.setStatus(static_cast<PlanStatus>(record.status));
+    }
+
+    simulation.actionsLog = actionsLog;
+    simulation.rebuildIndexes();
+}
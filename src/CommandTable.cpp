@@ -0,0 +1,176 @@
+#include "CommandTable.h"
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // The characters std::istream skips between words in the "C" locale
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    // Reads a leading integer the way std::istream does, ignoring what follows it
+    bool parseInt(const char *begin, const char *end, int &value) {
+        const char *digit = begin;
+        bool negative = digit != end && *digit == '-';
+        if (digit != end && (*digit == '-' || *digit == '+')) {
+            digit++;
+        }
+        if (digit == end || *digit < '0' || *digit > '9') {
+            return false;
+        }
+        long long result = 0;
+        for (; digit != end && *digit >= '0' && *digit <= '9'; digit++) {
+            result = result * 10 + (*digit - '0');
+            if (result > static_cast<long long>(INT_MAX) + 1) {
+                return false;
+            }
+        }
+        result = negative ? -result : result;
+        if (result > INT_MAX) {
+            return false;
+        }
+        value = static_cast<int>(result);
+        return true;
+    }
+
+    const char *skipSpaces(const char *position, const char *end) {
+        while (position != end && isSpace(*position)) {
+            position++;
+        }
+        return position;
+    }
+
+    const char *skipWord(const char *position, const char *end) {
+        while (position != end && !isSpace(*position)) {
+            position++;
+        }
+        return position;
+    }
+}
+
+CommandArgs::CommandArgs() : words(), integers(), valid() {}
+
+const string &CommandArgs::word(size_t i) const {
+    return words[i];
+}
+
+bool CommandArgs::isInt(size_t i) const {
+    return valid[i];
+}
+
+int CommandArgs::integer(size_t i) const {
+    return integers[i];
+}
+
+bool CommandArgs::toInt(const string &text, int &value) {
+    return parseInt(text.data(), text.data() + text.size(), value);
+}
+
+CommandTable::CommandTable() : commands(), slots(), seed(0), args() {}
+
+void CommandTable::add(const string &name, const string &spec, const CommandHandler &handler) {
+    if (name.empty() || skipWord(name.data(), name.data() + name.size()) != name.data() + name.size()) {
+        throw std::runtime_error("Invalid command name: " + name);
+    }
+    Command command = {name, vector<ArgumentKind>(), handler};
+    for (char kind : spec) {
+        if (kind == 'w') {
+            command.arguments.push_back(WORD);
+        } else if (kind == 'i') {
+            command.arguments.push_back(INTEGER);
+        } else {
+            throw std::runtime_error("Invalid argument spec for " + name + ": " + spec);
+        }
+    }
+    int existing = find(name.data(), name.data() + name.size());
+    if (existing >= 0) {
+        commands[existing] = command;
+        return;
+    }
+    commands.push_back(command);
+    rebuild();
+}
+
+bool CommandTable::contains(const string &name) const {
+    return find(name.data(), name.data() + name.size()) >= 0;
+}
+
+bool CommandTable::dispatch(Simulation &simulation, const string &line, string &command) {
+    const char *end = line.data() + line.size();
+    const char *nameBegin = skipSpaces(line.data(), end);
+    const char *nameEnd = skipWord(nameBegin, end);
+    int index = find(nameBegin, nameEnd);
+    if (index < 0) {
+        command.assign(nameBegin, nameEnd);
+        return false;
+    }
+
+    const Command &found = commands[index];
+    size_t count = found.arguments.size();
+    if (args.words.size() < count) {
+        args.words.resize(count);
+        args.integers.resize(count);
+        args.valid.resize(count);
+    }
+    const char *position = nameEnd;
+    for (size_t i = 0; i < count; i++) {
+        const char *argumentBegin = skipSpaces(position, end);
+        position = skipWord(argumentBegin, end);
+        args.words[i].assign(argumentBegin, position);
+        args.integers[i] = 0;
+        args.valid[i] = found.arguments[i] == INTEGER && parseInt(argumentBegin, position, args.integers[i]);
+    }
+    // The handler may add commands, which can move the one running
+    CommandHandler handler = found.handler;
+    handler(simulation, args);
+    return true;
+}
+
+int CommandTable::find(const char *begin, const char *end) const {
+    if (slots.empty()) {
+        return -1;
+    }
+    int index = slots[slotOf(begin, end)];
+    if (index < 0) {
+        return -1;
+    }
+    const string &name = commands[index].name;
+    size_t length = static_cast<size_t>(end - begin);
+    return name.size() == length && std::memcmp(name.data(), begin, length) == 0 ? index : -1;
+}
+
+// FNV-1a, starting from the table's seed
+size_t CommandTable::slotOf(const char *begin, const char *end) const {
+    unsigned int hash = seed;
+    for (const char *c = begin; c != end; c++) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    }
+    return hash & (slots.size() - 1);
+}
+
+// Looks for a seed that gives every name its own slot, growing the table
+// when a few hundred seeds all collide
+void CommandTable::rebuild() {
+    size_t size = 16;
+    while (size < commands.size() * 2) {
+        size *= 2;
+    }
+    for (;; size *= 2) {
+        slots.assign(size, -1);
+        for (unsigned int attempt = 0; attempt < 256; attempt++) {
+            seed = 2166136261u + attempt;
+            bool collided = false;
+            for (size_t i = 0; i < commands.size() && !collided; i++) {
+                const string &name = commands[i].name;
+                size_t slot = slotOf(name.data(), name.data() + name.size());
+                collided = slots[slot] >= 0;
+                slots[slot] = static_cast<int>(i);
+            }
+            if (!collided) {
+                return;
+            }
+            slots.assign(size, -1);
+        }
+    }
+}
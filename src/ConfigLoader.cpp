@@ -0,0 +1,197 @@
+#include "ConfigLoader.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+void ConfigLoader::load(Simulation &simulation, const char *data, size_t size, int threadCount) {
+    // Cut the file after a newline near every multiple of the chunk size
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount < 1 ? 1 : threadCount, size / MIN_CHUNK_SIZE));
+    vector<Chunk> chunks(chunkCount);
+    const char *end = data + size;
+    const char *begin = data;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char *cut = i + 1 == chunkCount ? end : data + size / chunkCount * (i + 1);
+        if (cut < begin) {
+            cut = begin;
+        }
+        const char *newline = static_cast<const char *>(std::memchr(cut, '\n', end - cut));
+        cut = newline != nullptr && i + 1 != chunkCount ? newline + 1 : end;
+        chunks[i].begin = begin;
+        chunks[i].end = cut;
+        begin = cut;
+    }
+
+    // Number the chunks' lines, then read their records
+    runParallel(chunks, [](Chunk &chunk) {
+        chunk.lineCount = static_cast<size_t>(std::count(chunk.begin, chunk.end, '\n'));
+    });
+    size_t line = 1;
+    for (Chunk &chunk : chunks) {
+        chunk.firstLine = line;
+        line += chunk.lineCount;
+    }
+    runParallel(chunks, parse);
+
+    // Settlements first, in file order, remembering where each was defined
+    vector<size_t> definedAt;
+    size_t position = 0;
+    bool stopped = false;
+    for (Chunk &chunk : chunks) {
+        chunk.position = position;
+        position += chunk.records.size();
+        for (size_t i = 0; i < chunk.records.size() && !stopped; i++) {
+            const Record &record = chunk.records[i];
+            if (record.kind == Record::SETTLEMENT) {
+                SettlementType type;
+                if (record.values[0] == 0) {
+                    type = SettlementType::VILLAGE;
+                } else if (record.values[0] == 1) {
+                    type = SettlementType::CITY;
+                } else {
+                    type = SettlementType::METROPOLIS;
+                }
+                simulation.addSettlement(new Settlement(record.name.str(), type));
+                definedAt.push_back(chunk.position + i);
+            }
+        }
+        stopped = stopped || chunk.failed;
+    }
+
+    runParallel(chunks, [&simulation, &definedAt](Chunk &chunk) {
+        resolvePlans(chunk, simulation, definedAt);
+    });
+
+    // Facility types and plans, in file order
+    size_t planCount = 0;
+    for (const Chunk &chunk : chunks) {
+        for (const Record &record : chunk.records) {
+            planCount += record.kind == Record::PLAN;
+        }
+    }
+    simulation.plans.reserve(planCount);
+    const Record *firstNeeding[3] = {nullptr, nullptr, nullptr}; // Plans by the category they pick from
+    for (const Chunk &chunk : chunks) {
+        for (const Record &record : chunk.records) {
+            if (record.kind == Record::FACILITY) {
+                FacilityCategory category;
+                if (record.values[0] == 0) {
+                    category = FacilityCategory::LIFE_QUALITY;
+                } else if (record.values[0] == 1) {
+                    category = FacilityCategory::ECONOMY;
+                } else {
+                    category = FacilityCategory::ENVIRONMENT;
+                }
+                simulation.addFacility(FacilityType(record.name.str(), category, record.values[1],
+                    record.values[2], record.values[3], record.values[4]));
+            } else if (record.kind == Record::PLAN) {
+                SelectionPolicy *selectionPolicy = simulation.createPolicy(record.policy.str());
+                if (selectionPolicy == nullptr) {
+                    throw std::runtime_error(errorAt(record, "unknown selection policy '" + record.policy.str() + "'"));
+                }
+                FacilityCategory category;
+                if (selectionPolicy->pickedCategory(category) && firstNeeding[static_cast<int>(category)] == nullptr) {
+                    firstNeeding[static_cast<int>(category)] = &record;
+                }
+                simulation.addPlan(record.settlement, selectionPolicy);
+            }
+        }
+        if (chunk.failed) {
+            throw std::runtime_error(chunk.error);
+        }
+    }
+
+    // Facility types may follow the plans that need them, so plans that pick
+    // from one category are only checked once the whole file is in
+    const Record *missing = nullptr;
+    for (int category = 0; category < 3; category++) {
+        const Record *record = firstNeeding[category];
+        if (record != nullptr && !simulation.facilitiesOptions.hasCategory(static_cast<FacilityCategory>(category))
+                && (missing == nullptr || record->line < missing->line)) {
+            missing = record;
+        }
+    }
+    if (missing != nullptr) {
+        throw std::runtime_error(errorAt(*missing, "no facility type in the category of policy '" + missing->policy.str() + "'"));
+    }
+}
+
+// A message for a plan's policy, placed like ConfigParser places its errors
+string ConfigLoader::errorAt(const Record &record, const string &message) {
+    return "config line " + std::to_string(record.line) + ", column " + std::to_string(record.policy.column) + ": " + message;
+}
+
+// Reads a chunk's records, stopping at the first bad line
+void ConfigLoader::parse(Chunk &chunk) {
+    ConfigParser parser(chunk.begin, static_cast<size_t>(chunk.end - chunk.begin), chunk.firstLine);
+    try {
+        ConfigToken keyword;
+        while (parser.nextLine()) {
+            if (!parser.nextToken(keyword)) {
+                continue;
+            }
+            Record record;
+            record.line = parser.getLineNumber();
+            if (keyword.equals("settlement")) {
+                record.kind = Record::SETTLEMENT;
+                record.name = parser.expectToken("settlement name");
+                record.values[0] = parser.expectInt("settlement type");
+            } else if (keyword.equals("facility")) {
+                record.kind = Record::FACILITY;
+                record.name = parser.expectToken("facility name");
+                record.values[0] = parser.expectInt("facility category");
+                record.values[1] = parser.expectInt("price");
+                record.values[2] = parser.expectInt("life quality score");
+                record.values[3] = parser.expectInt("economy score");
+                record.values[4] = parser.expectInt("environment score");
+            } else if (keyword.equals("plan")) {
+                record.kind = Record::PLAN;
+                record.name = parser.expectToken("settlement name");
+                record.policy = parser.expectToken("selection policy");
+            } else {
+                continue;
+            }
+            chunk.records.push_back(record);
+        }
+    } catch (const std::runtime_error &e) {
+        chunk.failed = true;
+        chunk.error = e.what();
+    }
+}
+
+// Finds every plan's settlement, which must be defined on an earlier line. An
+// unknown settlement cuts the chunk's records short, like a bad line does.
+void ConfigLoader::resolvePlans(Chunk &chunk, const Simulation &simulation, const vector<size_t> &definedAt) {
+    string settlementName; // Reused for every plan
+    for (size_t i = 0; i < chunk.records.size(); i++) {
+        Record &record = chunk.records[i];
+        if (record.kind != Record::PLAN) {
+            continue;
+        }
+        settlementName.assign(record.name.begin, record.name.end);
+        // Settlements are all interned by now, and nothing interns while plans resolve
+        std::unordered_map<Symbol, size_t>::const_iterator found = simulation.settlementIndex.find(NameTable::find(settlementName));
+        if (found == simulation.settlementIndex.end() || definedAt[found->second] > chunk.position + i) {
+            chunk.records.resize(i);
+            chunk.failed = true;
+            chunk.error = "config line " + std::to_string(record.line) + ", column " +
+                std::to_string(record.name.column) + ": unknown settlement '" + settlementName + "'";
+            return;
+        }
+        record.settlement = found->second;
+    }
+}
+
+void ConfigLoader::runParallel(vector<Chunk> &chunks, const std::function<void(Chunk &)> &work) {
+    if (chunks.size() == 1) {
+        work(chunks[0]);
+        return;
+    }
+    vector<std::thread> threads;
+    for (Chunk &chunk : chunks) {
+        threads.push_back(std::thread(work, std::ref(chunk)));
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
@@ -0,0 +1,99 @@
+#include "ConfigParser.h"
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // The characters std::istream skips between words in the "C" locale
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+}
+
+bool ConfigToken::equals(const char *word) const {
+    size_t length = std::strlen(word);
+    return static_cast<size_t>(end - begin) == length && std::memcmp(begin, word, length) == 0;
+}
+
+string ConfigToken::str() const {
+    return string(begin, end);
+}
+
+ConfigParser::ConfigParser(const char *data, size_t size, size_t firstLineNumber)
+    : end(data + size), nextLineBegin(data), lineBegin(data), lineEnd(data), position(data),
+      lineNumber(firstLineNumber - 1) {}
+
+bool ConfigParser::nextLine() {
+    while (nextLineBegin != end) {
+        lineNumber++;
+        lineBegin = nextLineBegin;
+        const char *newline = static_cast<const char *>(std::memchr(lineBegin, '\n', end - lineBegin));
+        lineEnd = newline != nullptr ? newline : end;
+        nextLineBegin = newline != nullptr ? newline + 1 : end;
+        position = lineBegin;
+        if (lineBegin != lineEnd && *lineBegin != '#') {
+            return true;
+        }
+    }
+    position = lineBegin = lineEnd = end;
+    return false;
+}
+
+bool ConfigParser::nextToken(ConfigToken &token) {
+    while (position != lineEnd && isSpace(*position)) {
+        position++;
+    }
+    if (position == lineEnd) {
+        return false;
+    }
+    token.begin = position;
+    while (position != lineEnd && !isSpace(*position)) {
+        position++;
+    }
+    token.end = position;
+    token.column = static_cast<size_t>(token.begin - lineBegin) + 1;
+    return true;
+}
+
+ConfigToken ConfigParser::expectToken(const char *what) {
+    ConfigToken token;
+    if (!nextToken(token)) {
+        fail(static_cast<size_t>(lineEnd - lineBegin) + 1, string("missing ") + what);
+    }
+    return token;
+}
+
+int ConfigParser::expectInt(const char *what) {
+    ConfigToken token = expectToken(what);
+    const char *digit = token.begin;
+    bool negative = *digit == '-';
+    if (*digit == '-' || *digit == '+') {
+        digit++;
+    }
+    if (digit == token.end || *digit < '0' || *digit > '9') {
+        fail(token.column, string("invalid ") + what + " '" + token.str() + "'");
+    }
+    long long value = 0;
+    for (; digit != token.end && *digit >= '0' && *digit <= '9'; digit++) {
+        value = value * 10 + (*digit - '0');
+        if (value > static_cast<long long>(INT_MAX) + 1) {
+            fail(token.column, string(what) + " out of range '" + token.str() + "'");
+        }
+    }
+    if (negative) {
+        value = -value;
+    }
+    if (value > INT_MAX) {
+        fail(token.column, string(what) + " out of range '" + token.str() + "'");
+    }
+    return static_cast<int>(value);
+}
+
+size_t ConfigParser::getLineNumber() const {
+    return lineNumber;
+}
+
+void ConfigParser::fail(size_t column, const string &message) const {
+    throw std::runtime_error("config line " + std::to_string(lineNumber) + ", column " +
+        std::to_string(column) + ": " + message);
+}
@@ -23,11 +23,15 @@ std::string FacilityCategoryToString(FacilityCategory category) {
 
 FacilityType::FacilityType(const string &name, const FacilityCategory category, const int price, 
                            const int lifeQuality_score, const int economy_score, const int environment_score)
-    : name(name), category(category), price(price), lifeQuality_score(lifeQuality_score), 
+    : name(NameTable::intern(name)), category(category), price(price), lifeQuality_score(lifeQuality_score), 
       economy_score(economy_score), environment_score(environment_score) {}
 
 const string &FacilityType::getName() const {
-     return name;
+     return NameTable::name(name);
+}
+
+Symbol FacilityType::getNameSymbol() const {
+    return name;
 }
 
 
@@ -56,13 +60,17 @@ Facility::Facility(const string &name, const string &settlementName, const Facil
                    const int price, const int lifeQuality_score, const int economy_score, 
                    const int environment_score)
     : FacilityType(name, category, price, lifeQuality_score, economy_score, environment_score), 
-      settlementName(settlementName), status(FacilityStatus::UNDER_CONSTRUCTIONS), timeLeft(price) {}
+      settlementName(NameTable::intern(settlementName)), status(FacilityStatus::UNDER_CONSTRUCTIONS), timeLeft(price) {}
 
 Facility::Facility(const FacilityType &type, const string &settlementName)
-    : FacilityType(type), settlementName(settlementName), 
+    : FacilityType(type), settlementName(NameTable::intern(settlementName)), 
       status(FacilityStatus::UNDER_CONSTRUCTIONS), timeLeft(type.getCost()) {}
 
 const string & Facility::getSettlementName() const{
+    return NameTable::name(settlementName);
+}
+
+Symbol Facility::getSettlementSymbol() const {
     return settlementName;
 }
 
@@ -87,13 +95,13 @@ const FacilityStatus& Facility::getStatus() const {
 }
 
 const string Facility::toString() const {
-    string toString = "Facility name: " + name + "\n"
+    string toString = "Facility name: " + getName() + "\n"
                       + "Facility category: " + FacilityCategoryToString(category) + "\n"
                       + "Facility price: " + std::to_string(price) + "\n"
                       + "Facility life quality score: " + std::to_string(lifeQuality_score) + "\n"
                       + "Facility life economy score: " + std::to_string(economy_score) + "\n"
                       + "Facility life environment score: " + std::to_string(environment_score) + "\n"
-                      + "Facility settlement name: " + settlementName + "\n"
+                      + "Facility settlement name: " + getSettlementName() + "\n"
                       + "Facility status: " + FacilityStatusToString(status) + "\n"
                       + "Facility time left: " + std::to_string(timeLeft);
     return toString;
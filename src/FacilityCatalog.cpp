@@ -0,0 +1,180 @@
+#include "FacilityCatalog.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+struct FacilityCatalog::WeightedOrders {
+    WeightedOrders() : mutex(), orders() {}
+
+    std::mutex mutex;
+    vector<std::shared_ptr<const WeightedOrder>> orders;
+};
+
+namespace {
+    std::atomic<unsigned long long> lastVersion(0);
+}
+
+FacilityCatalog::FacilityCatalog()
+    : types(), lifeQuality(), economy(), environment(), index(), weightedOrders(), contentVersion(++lastVersion), categoryTypes() {}
+
+FacilityCatalog &FacilityCatalog::operator=(const FacilityCatalog &other) {
+    if (this == &other) {
+        return *this;
+    }
+    types.clear();
+    for (const FacilityType &facility : other.types) {
+        types.push_back(facility);
+    }
+    lifeQuality = other.lifeQuality;
+    economy = other.economy;
+    environment = other.environment;
+    index = other.index;
+    weightedOrders = other.weightedOrders;
+    contentVersion = other.contentVersion;
+    for (int category = 0; category < 3; category++) {
+        categoryTypes[category] = other.categoryTypes[category];
+    }
+    return *this;
+}
+
+FacilityCatalog::FacilityCatalog(FacilityCatalog &&other)
+    : types(std::move(other.types)), lifeQuality(std::move(other.lifeQuality)), economy(std::move(other.economy)),
+      environment(std::move(other.environment)), index(std::move(other.index)),
+      weightedOrders(std::move(other.weightedOrders)), contentVersion(other.contentVersion), categoryTypes() {
+    for (int category = 0; category < 3; category++) {
+        categoryTypes[category] = std::move(other.categoryTypes[category]);
+    }
+    other.clear();
+}
+
+FacilityCatalog &FacilityCatalog::operator=(FacilityCatalog &&other) {
+    if (this == &other) {
+        return *this;
+    }
+    types = std::move(other.types);
+    lifeQuality = std::move(other.lifeQuality);
+    economy = std::move(other.economy);
+    environment = std::move(other.environment);
+    index = std::move(other.index);
+    weightedOrders = std::move(other.weightedOrders);
+    contentVersion = other.contentVersion;
+    for (int category = 0; category < 3; category++) {
+        categoryTypes[category] = std::move(other.categoryTypes[category]);
+    }
+    other.clear();
+    return *this;
+}
+
+size_t FacilityCatalog::size() const {
+    return types.size();
+}
+
+bool FacilityCatalog::empty() const {
+    return types.empty();
+}
+
+const FacilityType &FacilityCatalog::operator[](size_t i) const {
+    return types[i];
+}
+
+const FacilityType *FacilityCatalog::data() const {
+    return types.data();
+}
+
+FacilityCatalog::const_iterator FacilityCatalog::begin() const {
+    return types.begin();
+}
+
+FacilityCatalog::const_iterator FacilityCatalog::end() const {
+    return types.end();
+}
+
+void FacilityCatalog::push_back(const FacilityType &facility) {
+    types.push_back(facility);
+    lifeQuality.push_back(facility.getLifeQualityScore());
+    economy.push_back(facility.getEconomyScore());
+    environment.push_back(facility.getEnvironmentScore());
+    categoryTypes[static_cast<int>(facility.getCategory())].push_back(types.size() - 1);
+    index.reset();
+    weightedOrders.reset();
+    contentVersion = ++lastVersion;
+}
+
+void FacilityCatalog::clear() {
+    types.clear();
+    lifeQuality.clear();
+    economy.clear();
+    environment.clear();
+    for (vector<size_t> &indices : categoryTypes) {
+        indices.clear();
+    }
+    index.reset();
+    weightedOrders.reset();
+    contentVersion = ++lastVersion;
+}
+
+const int *FacilityCatalog::lifeQualityScores() const {
+    return lifeQuality.data();
+}
+
+const int *FacilityCatalog::economyScores() const {
+    return economy.data();
+}
+
+const int *FacilityCatalog::environmentScores() const {
+    return environment.data();
+}
+
+bool FacilityCatalog::hasCategory(FacilityCategory category) const {
+    return !categoryTypes[static_cast<int>(category)].empty();
+}
+
+size_t FacilityCatalog::nextInCategory(FacilityCategory category, long long after, size_t &position) const {
+    const vector<size_t> &indices = categoryTypes[static_cast<int>(category)];
+    if (indices.empty()) {
+        return SIZE_MAX;
+    }
+    if (after < 0) {
+        position = 0;
+    } else if (position < indices.size() && indices[position] == static_cast<size_t>(after)) {
+        position = (position + 1) % indices.size();
+    } else {
+        // Not where the caller left off, as after a restore
+        position = std::upper_bound(indices.begin(), indices.end(), static_cast<size_t>(after)) - indices.begin();
+        position %= indices.size();
+    }
+    return indices[position];
+}
+
+void FacilityCatalog::prepare() {
+    if (!index && types.size() >= BalancedIndex::MIN_CATALOG_SIZE) {
+        index = std::make_shared<const BalancedIndex>(*this);
+    }
+    if (!weightedOrders) {
+        weightedOrders = std::make_shared<WeightedOrders>();
+    }
+}
+
+const BalancedIndex *FacilityCatalog::balancedIndex() const {
+    return index.get();
+}
+
+std::shared_ptr<const WeightedOrder> FacilityCatalog::weightedOrder(double lifeQualityWeight, double economyWeight, double environmentWeight) const {
+    if (!weightedOrders) {
+        return std::make_shared<const WeightedOrder>(*this, lifeQualityWeight, economyWeight, environmentWeight);
+    }
+    std::lock_guard<std::mutex> lock(weightedOrders->mutex);
+    for (const std::shared_ptr<const WeightedOrder> &order : weightedOrders->orders) {
+        if (order->hasWeights(lifeQualityWeight, economyWeight, environmentWeight)) {
+            return order;
+        }
+    }
+    weightedOrders->orders.push_back(std::make_shared<const WeightedOrder>(*this, lifeQualityWeight, economyWeight, environmentWeight));
+    return weightedOrders->orders.back();
+}
+
+unsigned long long FacilityCatalog::version() const {
+    return contentVersion;
+}
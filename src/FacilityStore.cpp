@@ -0,0 +1,108 @@
+#include "FacilityStore.h"
+#include <limits>
+
+const long long FacilityStore::NEVER = std::numeric_limits<long long>::max();
+
+FacilityStore::FacilityStore()
+    : clock(0), nextFinish(NEVER), operationalTypes(), constructionTypes(), constructionFinish() {}
+
+size_t FacilityStore::operationalCount() const {
+    return operationalTypes.size();
+}
+
+int FacilityStore::getOperationalType(size_t i) const {
+    return operationalTypes[i];
+}
+
+void FacilityStore::addOperational(int typeIndex) {
+    operationalTypes.push_back(typeIndex);
+}
+
+void FacilityStore::clearOperational() {
+    operationalTypes.clear();
+}
+
+size_t FacilityStore::underConstructionCount() const {
+    return constructionTypes.size();
+}
+
+int FacilityStore::getUnderConstructionType(size_t i) const {
+    return constructionTypes[i];
+}
+
+int FacilityStore::getTimeLeft(size_t i) const {
+    return static_cast<int>(constructionFinish[i] - clock);
+}
+
+void FacilityStore::addUnderConstruction(int typeIndex, int timeLeft) {
+    long long finish = clock + timeLeft;
+    constructionTypes.push_back(typeIndex);
+    constructionFinish.push_back(finish);
+    // A facility without a positive build time never counts down to zero
+    if (finish > clock && finish < nextFinish) {
+        nextFinish = finish;
+    }
+}
+
+void FacilityStore::clearUnderConstruction() {
+    constructionTypes.clear();
+    constructionFinish.clear();
+    nextFinish = NEVER;
+}
+
+long long FacilityStore::getClock() const {
+    return clock;
+}
+
+size_t FacilityStore::stepConstruction() {
+    clock++;
+    if (clock != nextFinish) {
+        return 0;
+    }
+
+    // Batch promotion of everything finishing now, in construction order
+    size_t kept = 0;
+    size_t before = operationalTypes.size();
+    for (size_t i = 0; i < constructionTypes.size(); i++) {
+        if (constructionFinish[i] == clock) {
+            operationalTypes.push_back(constructionTypes[i]);
+        } else {
+            constructionTypes[kept] = constructionTypes[i];
+            constructionFinish[kept] = constructionFinish[i];
+            kept++;
+        }
+    }
+    constructionTypes.resize(kept);
+    constructionFinish.resize(kept);
+    updateNextFinish();
+    return operationalTypes.size() - before;
+}
+
+void FacilityStore::repeatOperational(size_t from, long long times) {
+    size_t end = operationalTypes.size();
+    for (long long t = 0; t < times; t++) {
+        for (size_t i = from; i < end; i++) {
+            int typeIndex = operationalTypes[i];
+            operationalTypes.push_back(typeIndex);
+        }
+    }
+}
+
+void FacilityStore::skipSteps(long long steps) {
+    clock += steps;
+    for (long long &finish : constructionFinish) {
+        finish += steps;
+    }
+    if (nextFinish != NEVER) {
+        nextFinish += steps;
+    }
+}
+
+void FacilityStore::updateNextFinish() {
+    nextFinish = NEVER;
+    for (long long finish : constructionFinish) {
+        if (finish > clock && finish < nextFinish) {
+            nextFinish = finish;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "Leaderboard.h"
+#include <algorithm>
+
+const size_t Leaderboard::REBUILD_SHARE;
+
+Leaderboard::Leaderboard() : rankings(std::make_shared<Rankings>()), changed(), isChanged() {}
+
+bool Leaderboard::parseMetric(const string &name, Metric &metric) {
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        if (name == metricName(static_cast<Metric>(i))) {
+            metric = static_cast<Metric>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *Leaderboard::metricName(Metric metric) {
+    switch (metric) {
+        case LIFE_QUALITY:
+            return "life";
+        case ECONOMY:
+            return "economy";
+        case ENVIRONMENT:
+            return "env";
+        case BALANCED:
+            return "balanced";
+        default:
+            return "";
+    }
+}
+
+// A comparison per ranked plan that isn't marked yet
+void Leaderboard::update(const vector<Plan> &plans) {
+    const vector<Scores> &ranked = rankings->ranked;
+    size_t count = std::min(ranked.size(), plans.size());
+    isChanged.resize(ranked.size());
+    for (size_t i = 0; i < count; i++) {
+        if (!isChanged[i] && !(scoresOf(plans[i]) == ranked[i])) {
+            isChanged[i] = true;
+            changed.push_back(i);
+        }
+    }
+}
+
+void Leaderboard::clear() {
+    rankings = std::make_shared<Rankings>();
+    changed.clear();
+    isChanged.clear();
+}
+
+void Leaderboard::top(const vector<Plan> &plans, Metric metric, size_t count, vector<size_t> &positions) {
+    rerank(plans);
+    positions.clear();
+    const Ranking &ranking = rankings->byMetric[metric];
+    for (Ranking::const_iterator it = ranking.begin(); it != ranking.end() && positions.size() < count; ++it) {
+        positions.push_back(it->position);
+    }
+}
+
+bool Leaderboard::Scores::operator==(const Scores &other) const {
+    return lifeQuality == other.lifeQuality && economy == other.economy && environment == other.environment;
+}
+
+bool Leaderboard::Ranked::operator<(const Ranked &other) const {
+    return score != other.score ? score > other.score : position < other.position;
+}
+
+Leaderboard::Scores Leaderboard::scoresOf(const Plan &plan) {
+    Scores scores = {plan.getlifeQualityScore(), plan.getEconomyScore(), plan.getEnvironmentScore()};
+    return scores;
+}
+
+long long Leaderboard::score(const Scores &scores, int metric) {
+    switch (metric) {
+        case LIFE_QUALITY:
+            return scores.lifeQuality;
+        case ECONOMY:
+            return scores.economy;
+        case ENVIRONMENT:
+            return scores.environment;
+        default:
+            return std::min(scores.lifeQuality, std::min(scores.economy, scores.environment));
+    }
+}
+
+// Moves the marked plans to their current scores and ranks the new ones.
+// When a good share of the plans moved, as after a step of many plans, the
+// rankings are rebuilt from sorted scores instead, which is several times
+// faster than as many single moves.
+void Leaderboard::rerank(const vector<Plan> &plans) {
+    size_t added = plans.size() - std::min(plans.size(), rankings->ranked.size());
+    if (changed.empty() && added == 0) {
+        return;
+    }
+    if ((changed.size() + added) * REBUILD_SHARE >= plans.size()) {
+        rebuild(plans);
+        return;
+    }
+    if (rankings.use_count() > 1) {
+        rankings = std::make_shared<Rankings>(*rankings);
+    }
+    vector<Scores> &ranked = rankings->ranked;
+    for (size_t position : changed) {
+        Scores scores = scoresOf(plans[position]);
+        for (int metric = 0; metric < METRIC_COUNT; metric++) {
+            Ranked before = {score(ranked[position], metric), position};
+            Ranked after = {score(scores, metric), position};
+            if (before.score != after.score) {
+                rankings->byMetric[metric].erase(before);
+                rankings->byMetric[metric].insert(after);
+            }
+        }
+        ranked[position] = scores;
+        isChanged[position] = false;
+    }
+    changed.clear();
+    for (size_t position = ranked.size(); position < plans.size(); position++) {
+        Scores scores = scoresOf(plans[position]);
+        ranked.push_back(scores);
+        for (int metric = 0; metric < METRIC_COUNT; metric++) {
+            Ranked entry = {score(scores, metric), position};
+            rankings->byMetric[metric].insert(entry);
+        }
+    }
+}
+
+void Leaderboard::rebuild(const vector<Plan> &plans) {
+    std::shared_ptr<Rankings> rebuilt = std::make_shared<Rankings>();
+    rebuilt->ranked.reserve(plans.size());
+    for (const Plan &plan : plans) {
+        rebuilt->ranked.push_back(scoresOf(plan));
+    }
+    vector<Ranked> entries(plans.size());
+    for (int metric = 0; metric < METRIC_COUNT; metric++) {
+        for (size_t position = 0; position < plans.size(); position++) {
+            entries[position].score = score(rebuilt->ranked[position], metric);
+            entries[position].position = position;
+        }
+        std::sort(entries.begin(), entries.end());
+        // Sorted input is inserted at the end each time, in linear time
+        rebuilt->byMetric[metric].insert(entries.begin(), entries.end());
+    }
+    rankings = rebuilt;
+    changed.clear();
+    isChanged.assign(plans.size(), false);
+}
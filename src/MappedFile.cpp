@@ -0,0 +1,47 @@
+#include "MappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const string &path) : opened(false), contents(nullptr), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            length = 0;
+            return;
+        }
+        contents = static_cast<const char *>(mapped);
+    }
+    close(fd);
+    opened = true;
+}
+
+MappedFile::~MappedFile() {
+    if (contents != nullptr) {
+        munmap(const_cast<char *>(contents), length);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char *MappedFile::data() const {
+    return contents;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
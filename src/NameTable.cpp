@@ -0,0 +1,68 @@
+#include "NameTable.h"
+
+const Symbol NameTable::NONE;
+
+NameTable::NameTable() : names(), slots(1024, NONE) {}
+
+NameTable &NameTable::instance() {
+    static NameTable table;
+    return table;
+}
+
+// FNV-1a
+uint32_t NameTable::hash(const string &name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+size_t NameTable::slotOf(const string &name) const {
+    size_t mask = slots.size() - 1;
+    size_t slot = hash(name) & mask;
+    while (slots[slot] != NONE && names[slots[slot]] != name) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void NameTable::grow() {
+    vector<Symbol> old(slots.size() * 2, NONE);
+    old.swap(slots);
+    for (Symbol symbol : old) {
+        if (symbol != NONE) {
+            slots[slotOf(names[symbol])] = symbol;
+        }
+    }
+}
+
+Symbol NameTable::intern(const string &name) {
+    NameTable &table = instance();
+    size_t slot = table.slotOf(name);
+    if (table.slots[slot] != NONE) {
+        return table.slots[slot];
+    }
+    Symbol symbol = static_cast<Symbol>(table.names.size());
+    table.names.push_back(name);
+    table.slots[slot] = symbol;
+    // At most half full, so probes stay short
+    if (table.names.size() * 2 > table.slots.size()) {
+        table.grow();
+    }
+    return symbol;
+}
+
+Symbol NameTable::find(const string &name) {
+    const NameTable &table = instance();
+    return table.slots[table.slotOf(name)];
+}
+
+const string &NameTable::name(Symbol symbol) {
+    static const string none;
+    return symbol == NONE ? none : instance().names[symbol];
+}
+
+size_t NameTable::size() {
+    return instance().names.size();
+}
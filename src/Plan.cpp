@@ -2,95 +2,120 @@
 #include <iostream>
 #include <sstream>
 #include <utility> // For std::move
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <type_traits>
+
+namespace {
+
+struct CycleKeyHash {
+    size_t operator()(const vector<long long> &key) const {
+        size_t hash = key.size();
+        for (long long value : key) {
+            hash ^= std::hash<long long>()(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+// What the plan looked like after a step, to measure a cycle once one is found
+struct CycleMark {
+    size_t operationalCount;
+    long long lifeQuality, economy, environment;
+    vector<long long> counters;
+};
+
+// Source of plan versions, shared by every simulation and its backups
+std::atomic<unsigned long long> nextVersion(1);
 
-Plan::Plan(const int planId, const Settlement &settlement, SelectionPolicy *selectionPolicy, const vector<FacilityType> &facilityOptions)
+// States remembered while looking for a cycle, on top of one per facility type
+const size_t CYCLE_SEARCH_BUDGET = 4096;
+
+} // namespace
+
+Plan::Plan(const int planId, size_t settlementIndex, const Settlement &settlement, SelectionPolicy *selectionPolicy)
     : plan_id(planId),
-      settlement(settlement),
+      settlementIndex(settlementIndex),
+      settlementName(settlement.getNameSymbol()),
+      constructionLimit(settlement.getConstructionLimit()),
       selectionPolicy(selectionPolicy),
       status(PlanStatus::AVALIABLE),
       facilities(),
-      underConstruction(),
-      facilityOptions(facilityOptions),
       life_quality_score(0),
       economy_score(0),
-      environment_score(0) {}
+      environment_score(0),
+      version(nextVersion++) {}
 
 
 Plan::Plan(const Plan &other)
     : plan_id(other.plan_id),
-      settlement(other.settlement),
+      settlementIndex(other.settlementIndex),
+      settlementName(other.settlementName),
+      constructionLimit(other.constructionLimit),
       selectionPolicy(other.selectionPolicy->clone()), // Initialize to nullptr to safely manage memory
       status(other.status),
-      facilities(),
-      underConstruction(),
-      facilityOptions(other.facilityOptions),
+      facilities(other.facilities),
       life_quality_score(other.life_quality_score),
       economy_score(other.economy_score),
-      environment_score(other.environment_score) {
-
-    // Deep copy facilities
-    for (Facility* facility : other.facilities) {
-        facilities.push_back(new Facility(*facility));
-    }
-
-    // Deep copy underConstruction
-    for (Facility* facility : other.underConstruction) {
-        underConstruction.push_back(new Facility(*facility));
-    }
-}
+      environment_score(other.environment_score),
+      version(other.version) {}
 
 
-Plan::Plan(const Plan &other, const Settlement &newSettlement)
+Plan::Plan(Plan &&other) noexcept
     : plan_id(other.plan_id),
-      settlement(newSettlement), // Assign the new settlement
-      selectionPolicy(other.selectionPolicy->clone()),
+      settlementIndex(other.settlementIndex),
+      settlementName(other.settlementName),
+      constructionLimit(other.constructionLimit),
+      selectionPolicy(other.selectionPolicy),
       status(other.status),
-      facilities(),
-      underConstruction(),
-      facilityOptions(other.facilityOptions),
+      facilities(std::move(other.facilities)),
       life_quality_score(other.life_quality_score),
       economy_score(other.economy_score),
-      environment_score(other.environment_score) {
-    // Deep copy facilities
-    for (Facility* facility : other.facilities) {
-        Facility* f = new Facility(*facility);
-        facilities.push_back(f);
-    }
-    for (Facility* facility : other.underConstruction) {
-        Facility* f = new Facility(*facility);
-        underConstruction.push_back(f);
-    }
+      environment_score(other.environment_score),
+      version(other.version) {
+    other.selectionPolicy = nullptr;
 }
 
+// vector<Plan> only moves its plans when it grows if moving can't throw
+static_assert(std::is_nothrow_move_constructible<Plan>::value, "moving a Plan must not throw");
+
 
 // Copy assignment operator
 Plan& Plan::operator=(const Plan &other) {
     if (this != &other) {
         // Clean up existing resources
         delete selectionPolicy;
-        for (const Facility* facility : facilities) {
-            delete facility;
-        }
-        facilities.clear();
-        for (const Facility* facility : underConstruction) {
-            delete facility;
-        }
-        underConstruction.clear();
-        // Do not reassign settlement; it is immutable
         selectionPolicy = other.selectionPolicy->clone();
         plan_id = other.plan_id;
+        settlementIndex = other.settlementIndex;
+        settlementName = other.settlementName;
+        constructionLimit = other.constructionLimit;
         status = other.status;
         life_quality_score = other.life_quality_score;
         economy_score = other.economy_score;
         environment_score = other.environment_score;
+        facilities = other.facilities;
+        version = other.version;
+    }
+    return *this;
+}
 
-        for (Facility* facility : other.facilities) {
-            facilities.push_back(new Facility(*facility));
-        }
-        
-        for (Facility* facility : other.underConstruction) {
-            underConstruction.push_back(new Facility(*facility));
-        }
+Plan& Plan::operator=(Plan &&other) noexcept {
+    if (this != &other) {
+        delete selectionPolicy;
+        selectionPolicy = other.selectionPolicy;
+        other.selectionPolicy = nullptr;
+        plan_id = other.plan_id;
+        settlementIndex = other.settlementIndex;
+        settlementName = other.settlementName;
+        constructionLimit = other.constructionLimit;
+        status = other.status;
+        life_quality_score = other.life_quality_score;
+        economy_score = other.economy_score;
+        environment_score = other.environment_score;
+        facilities = std::move(other.facilities);
+        version = other.version;
     }
     return *this;
 }
@@ -100,14 +125,6 @@ Plan& Plan::operator=(const Plan &other) {
 // Destructor
 Plan::~Plan() {
     delete selectionPolicy; // Free dynamically allocated selection policy
-    for (Facility* facility : facilities) {
-        delete facility; // Free dynamically allocated facilities
-    }
-    facilities.clear();
-    for (Facility* facility : underConstruction) {
-        delete facility;
-    }
-    underConstruction.clear();
 }
 
 // Methods
@@ -124,6 +141,7 @@ const int Plan::getEnvironmentScore() const {
 }
 
 void Plan::setSelectionPolicy(SelectionPolicy *newPolicy) {
+    touch();
     delete this->selectionPolicy;
     this->selectionPolicy = newPolicy;
 }
@@ -132,14 +150,27 @@ const SelectionPolicy* Plan:: getSelectionPolicy() const{
     return selectionPolicy;
 }
 
-const Settlement& Plan:: getSettlement() const{
-    return settlement;
+size_t Plan::getSettlementIndex() const {
+    return settlementIndex;
+}
+
+const string &Plan::getSettlementName() const {
+    return NameTable::name(settlementName);
+}
+
+int Plan::getConstructionLimit() const {
+    return constructionLimit;
+}
+
+void Plan::step(const FacilityCatalog &facilityOptions) {
+    touch();
+    stepOnce(facilityOptions);
 }
 
-void Plan::step() {
+void Plan::stepOnce(const FacilityCatalog &facilityOptions) {
 
     // Check if the plan should be BUSY or AVAILABLE
-    if (underConstruction.size() >= static_cast<size_t>(settlement.getConstructionLimit())) {
+    if (facilities.underConstructionCount() >= static_cast<size_t>(constructionLimit)) {
         status = PlanStatus::BUSY;
     } else {
         status = PlanStatus::AVALIABLE;
@@ -148,31 +179,25 @@ void Plan::step() {
     // Add new facilities if AVAILABLE and within limits
     if (status == PlanStatus::AVALIABLE) 
     {
-        while (underConstruction.size() < static_cast<size_t>(settlement.getConstructionLimit())) 
+        SelectionContext context = {life_quality_score, economy_score, environment_score, constructionLimit, &facilities};
+        while (facilities.underConstructionCount() < static_cast<size_t>(constructionLimit)) 
         {
-            const FacilityType& selectedFacilityType = selectionPolicy->selectFacility(facilityOptions);
-            Facility* f = new Facility(selectedFacilityType, settlement.getName());
-            underConstruction.push_back(f);
+            const FacilityType& selectedFacilityType = selectionPolicy->selectFacilityFor(facilityOptions, context);
+            facilities.addUnderConstruction(static_cast<int>(&selectedFacilityType - facilityOptions.data()), selectedFacilityType.getCost());
         }
     }
 
-    // Process facilities under construction
-    for (auto it = underConstruction.begin(); it != underConstruction.end();) {
-        Facility* facility = *it;
-        FacilityStatus status = facility->step(); // Decrement time left
-        if (status == FacilityStatus::OPERATIONAL) {
-            facilities.push_back(facility); // Move to operational facilities
-            life_quality_score += facility->getLifeQualityScore();
-            economy_score += facility->getEconomyScore();
-            environment_score += facility->getEnvironmentScore();
-            it = underConstruction.erase(it); // Remove from underConstruction
-        } else {
-            ++it;
-        }
+    // Process facilities under construction, finished ones become operational
+    size_t completed = facilities.stepConstruction();
+    for (size_t i = facilities.operationalCount() - completed; i < facilities.operationalCount(); i++) {
+        const FacilityType &facility = facilityOptions[facilities.getOperationalType(i)];
+        life_quality_score += facility.getLifeQualityScore();
+        economy_score += facility.getEconomyScore();
+        environment_score += facility.getEnvironmentScore();
     }
     
     // Re-check status after adding facilities
-    if (underConstruction.size() >= static_cast<size_t>(settlement.getConstructionLimit())) {
+    if (facilities.underConstructionCount() >= static_cast<size_t>(constructionLimit)) {
         status = PlanStatus::BUSY;
     } else {
         status = PlanStatus::AVALIABLE;
@@ -180,33 +205,110 @@ void Plan::step() {
 }
 
 
-void Plan::printStatus() {
-    std::cout << toString() << std::endl;
+// Steps numOfSteps times. Once the plan's state (policy position and the time
+// left on every pending facility) repeats, the plan is in a cycle: every
+// further round builds the same facilities and adds the same scores, so whole
+// rounds are applied arithmetically and only the remainder is really stepped.
+void Plan::step(int numOfSteps, const FacilityCatalog &facilityOptions) {
+    touch();
+    vector<long long> key, counters;
+    if (numOfSteps < FAST_FORWARD_MIN_STEPS || !selectionPolicy->getCycleState(key, counters)) {
+        for (int i = 0; i < numOfSteps; i++) {
+            stepOnce(facilityOptions);
+        }
+        return;
+    }
+
+    std::unordered_map<vector<long long>, int, CycleKeyHash> seen;
+    vector<CycleMark> marks;
+    size_t budget = CYCLE_SEARCH_BUDGET + facilityOptions.size();
+    int done = 0;
+    while (true) {
+        key.clear();
+        counters.clear();
+        getCycleKey(key, counters);
+        auto found = seen.find(key);
+        if (found != seen.end()) {
+            const CycleMark &start = marks[found->second];
+            long long length = done - found->second;
+            long long cycles = (numOfSteps - done) / length;
+            if (cycles > 0) {
+                vector<long long> counterDeltas;
+                for (size_t i = 0; i < counters.size(); i++) {
+                    counterDeltas.push_back((counters[i] - start.counters[i]) * cycles);
+                }
+                selectionPolicy->skipCycles(counterDeltas);
+                facilities.repeatOperational(start.operationalCount, cycles);
+                facilities.skipSteps(length * cycles);
+                life_quality_score = static_cast<int>(life_quality_score + (life_quality_score - start.lifeQuality) * cycles);
+                economy_score = static_cast<int>(economy_score + (economy_score - start.economy) * cycles);
+                environment_score = static_cast<int>(environment_score + (environment_score - start.environment) * cycles);
+                done += static_cast<int>(length * cycles);
+            }
+            break;
+        }
+        if (done == numOfSteps || marks.size() >= budget) {
+            break;
+        }
+        seen.insert(std::make_pair(key, done));
+        CycleMark mark = {facilities.operationalCount(), life_quality_score, economy_score, environment_score, counters};
+        marks.push_back(mark);
+        stepOnce(facilityOptions);
+        done++;
+    }
+    for (; done < numOfSteps; done++) {
+        stepOnce(facilityOptions);
+    }
+}
+
+// Everything the next steps depend on, apart from the fixed catalog
+void Plan::getCycleKey(vector<long long> &key, vector<long long> &counters) const {
+    selectionPolicy->getCycleState(key, counters);
+    for (size_t i = 0; i < facilities.underConstructionCount(); i++) {
+        key.push_back(facilities.getUnderConstructionType(i));
+        key.push_back(facilities.getTimeLeft(i));
+    }
+}
+
+void Plan::printStatus(const FacilityCatalog &facilityOptions) const {
+    std::cout << toString(facilityOptions) << '\n';
 }
 
-const vector<Facility*> &Plan::getFacilities() const {
+const FacilityStore &Plan::getFacilities() const {
     return facilities;
 }
 
-const vector<Facility*> &Plan::getUnderConstructionFacilities() const {
-    return underConstruction;
+
+
+void Plan::setFacilities(const FacilityStore &facilities) {
+    touch();
+    this->facilities = facilities;
 }
 
+PlanStatus Plan::getStatus() const {
+    return status;
+}
 
+void Plan::setStatus(PlanStatus status) {
+    touch();
+    this->status = status;
+}
 
-void Plan::addFacility(Facility* facility) {
-    underConstruction.push_back(facility);
+void Plan::addFacility(int typeIndex) {
+    touch();
+    facilities.addOperational(typeIndex);
 }
 
 
-void Plan::addUnderConstructionFacility(Facility* facility) {
-    underConstruction.push_back(facility);
+void Plan::addUnderConstructionFacility(int typeIndex, const FacilityCatalog &facilityOptions) {
+    touch();
+    facilities.addUnderConstruction(typeIndex, facilityOptions[typeIndex].getCost());
 }
 
-const std::string Plan::toString() const {
+const std::string Plan::toString(const FacilityCatalog &facilityOptions) const {
     std::ostringstream result;
     result << "PlanID: " << plan_id << "\n";
-    result << "SettlementName: " << settlement.getName() << "\n";
+    result << "SettlementName: " << getSettlementName() << "\n";
     result << "PlanStatus: " << (status == PlanStatus::AVALIABLE ? "AVAILABLE" : "BUSY") << "\n";
     result << "SelectionPolicy: " << (selectionPolicy ? selectionPolicy->toString() : "None") << "\n";
     result << "LifeQualityScore: " << life_quality_score << "\n";
@@ -214,14 +316,14 @@ const std::string Plan::toString() const {
     result << "EnvironmentScore: " << environment_score << "\n";
 
     // Print facilities under construction
-    for (const Facility* facility : underConstruction) {
-        result << "FacilityName: " << facility->getName() << "\n";
+    for (size_t i = 0; i < facilities.underConstructionCount(); i++) {
+        result << "FacilityName: " << facilityOptions[facilities.getUnderConstructionType(i)].getName() << "\n";
         result << "FacilityStatus: UNDER_CONSTRUCTION" << "\n";
     }
 
     // print existing facilities
-    for (const Facility* facility : facilities) {
-        result << "FacilityName: " << facility->getName() << "\n";
+    for (size_t i = 0; i < facilities.operationalCount(); i++) {
+        result << "FacilityName: " << facilityOptions[facilities.getOperationalType(i)].getName() << "\n";
         result << "FacilityStatus: OPERATIONAL" << "\n";
     }
 
@@ -231,7 +333,7 @@ const std::string Plan::toString() const {
 const std::string Plan::shortenedToString() const{
     std::ostringstream result;
     result << "PlanID: " << plan_id << "\n";
-    result << "SettlementName: " << settlement.getName() << "\n";
+    result << "SettlementName: " << getSettlementName() << "\n";
     result << "LifeQualityScore: " << life_quality_score << "\n";
     result << "EconomyScore: " << economy_score << "\n";
     result << "EnvironmentScore: " << environment_score << "\n";
@@ -240,6 +342,7 @@ const std::string Plan::shortenedToString() const{
 }
 
 void Plan::setScores(int lifeQualityScore, int economyScore, int environmentScore) {
+    touch();
     life_quality_score = lifeQualityScore;
     economy_score = economyScore;
     environment_score = environmentScore;
@@ -251,15 +354,19 @@ const int Plan:: getPlanID() const{
 }
 
 void Plan::clearFacilities() {
-    for (Facility* facility : facilities) {
-        delete facility; // Free dynamically allocated memory
-    }
-    facilities.clear(); // Clear the vector
+    touch();
+    facilities.clearOperational();
 }
 
 void Plan::clearUnderConstructionFacilities() {
-    for (Facility* facility : underConstruction) {
-        delete facility; // Free dynamically allocated memory
-    }
-    underConstruction.clear(); // Clear the vector
+    touch();
+    facilities.clearUnderConstruction();
+}
+
+unsigned long long Plan::getVersion() const {
+    return version;
+}
+
+void Plan::touch() {
+    version = nextVersion++;
 }
@@ -0,0 +1,72 @@
+#include "PlanStats.h"
+
+namespace {
+    const PlanTotals NO_PLANS = {0, 0, 0, 0, 0, 0, 0};
+}
+
+PlanStats::PlanStats() : counted(), settlements(), totals(NO_PLANS) {}
+
+void PlanStats::add(const Plan &plan) {
+    counted.push_back(countedOf(plan));
+    apply(plan.getSettlementIndex(), counted.back(), 1);
+}
+
+void PlanStats::update(const vector<Plan> &plans) {
+    for (size_t i = 0; i < counted.size() && i < plans.size(); i++) {
+        Counted now = countedOf(plans[i]);
+        if (!(now == counted[i])) {
+            apply(plans[i].getSettlementIndex(), counted[i], -1);
+            apply(plans[i].getSettlementIndex(), now, 1);
+            counted[i] = now;
+        }
+    }
+    for (size_t i = counted.size(); i < plans.size(); i++) {
+        add(plans[i]);
+    }
+}
+
+void PlanStats::clear() {
+    counted.clear();
+    settlements.clear();
+    totals = NO_PLANS;
+}
+
+const PlanTotals &PlanStats::total() const {
+    return totals;
+}
+
+PlanTotals PlanStats::settlementTotal(size_t settlementIndex) const {
+    return settlementIndex < settlements.size() ? settlements[settlementIndex] : NO_PLANS;
+}
+
+bool PlanStats::Counted::operator==(const Counted &other) const {
+    return lifeQuality == other.lifeQuality && economy == other.economy && environment == other.environment &&
+        operational == other.operational && underConstruction == other.underConstruction && busy == other.busy;
+}
+
+PlanStats::Counted PlanStats::countedOf(const Plan &plan) {
+    Counted result = {plan.getlifeQualityScore(), plan.getEconomyScore(), plan.getEnvironmentScore(),
+        plan.getFacilities().operationalCount(), plan.getFacilities().underConstructionCount(),
+        plan.getStatus() == PlanStatus::BUSY};
+    return result;
+}
+
+void PlanStats::apply(size_t settlementIndex, const Counted &counted, long long sign) {
+    if (settlementIndex >= settlements.size()) {
+        settlements.resize(settlementIndex + 1, NO_PLANS);
+    }
+    apply(settlements[settlementIndex], counted, sign);
+    apply(totals, counted, sign);
+}
+
+// Sizes wrap around on subtraction and come back when the plan is re-added
+void PlanStats::apply(PlanTotals &totals, const Counted &counted, long long sign) {
+    size_t step = static_cast<size_t>(sign);
+    totals.plans += step;
+    totals.busyPlans += counted.busy ? step : 0;
+    totals.operationalFacilities += step * counted.operational;
+    totals.underConstructionFacilities += step * counted.underConstruction;
+    totals.lifeQualityScore += sign * counted.lifeQuality;
+    totals.economyScore += sign * counted.economy;
+    totals.environmentScore += sign * counted.environment;
+}
@@ -0,0 +1,23 @@
+#include "PolicyRegistry.h"
+
+PolicyRegistry::PolicyRegistry() : factories() {}
+
+void PolicyRegistry::add(const string &name, const PolicyFactory &factory) {
+    factories[name] = factory;
+}
+
+SelectionPolicy *PolicyRegistry::create(const string &name, int lifeQuality, int economy, int environment) const {
+    auto found = factories.find(name);
+    if (found != factories.end() && (name.empty() || name.back() != ':')) {
+        return found->second(string(), lifeQuality, economy, environment);
+    }
+    size_t colon = name.find(':');
+    if (colon == string::npos) {
+        return nullptr;
+    }
+    found = factories.find(name.substr(0, colon + 1));
+    if (found == factories.end()) {
+        return nullptr;
+    }
+    return found->second(name.substr(colon + 1), lifeQuality, economy, environment);
+}
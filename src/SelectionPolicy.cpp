@@ -1,14 +1,159 @@
 #include "SelectionPolicy.h"
+#include "BalancedScan.h"
+#include "FacilityStore.h"
+#include "StepEngine.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
 #include <sstream>
 #include <limits>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+struct SearchKeyHash {
+    size_t operator()(const vector<long long> &key) const {
+        size_t hash = key.size();
+        for (long long value : key) {
+            hash ^= std::hash<long long>()(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+// Threads that lookahead searches share, started on first use and kept for
+// the rest of the process. One batch of tasks runs at a time; the thread that
+// runs a batch works on it too, and gets the batch's first error rethrown.
+class SearchThreads {
+    public:
+        static SearchThreads &shared() {
+            static SearchThreads *threads = new SearchThreads();
+            return *threads;
+        }
+        SearchThreads(const SearchThreads &other) = delete;
+        SearchThreads &operator=(const SearchThreads &other) = delete;
+
+        size_t size() const {
+            return threads.size() + 1;
+        }
+
+        // Calls task(i) for every i < count, spread over the threads
+        void run(size_t count, const std::function<void(size_t)> &task) {
+            std::lock_guard<std::mutex> oneBatch(batchLock);
+            std::unique_lock<std::mutex> guard(lock);
+            this->task = &task;
+            this->count = count;
+            next = 0;
+            unfinished = count;
+            errors.assign(count, std::exception_ptr());
+            batch++;
+            wake.notify_all();
+            work(guard);
+            finished.wait(guard, [this]() { return unfinished == 0; });
+            this->task = nullptr;
+            for (const std::exception_ptr &error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+    private:
+        SearchThreads() : batchLock(), lock(), wake(), finished(), task(nullptr), count(0), next(0), unfinished(0),
+                          batch(0), errors(), threads() {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            for (unsigned int i = 1; i < hardware; i++) {
+                threads.push_back(std::thread([this]() { serve(); }));
+            }
+        }
+
+        void serve() {
+            std::unique_lock<std::mutex> guard(lock);
+            unsigned long long served = 0;
+            while (true) {
+                wake.wait(guard, [this, served]() { return batch != served; });
+                served = batch;
+                work(guard);
+            }
+        }
+
+        // Takes tasks of the current batch until none are left; holds guard
+        // except while a task runs
+        void work(std::unique_lock<std::mutex> &guard) {
+            while (next < count) {
+                size_t i = next++;
+                const std::function<void(size_t)> &current = *task;
+                guard.unlock();
+                std::exception_ptr error;
+                try {
+                    current(i);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                guard.lock();
+                errors[i] = error;
+                if (--unfinished == 0) {
+                    finished.notify_all();
+                }
+            }
+        }
+
+        std::mutex batchLock;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        const std::function<void(size_t)> *task;
+        size_t count, next, unfinished;
+        unsigned long long batch;
+        vector<std::exception_ptr> errors; // By task
+        vector<std::thread> threads;
+};
+
+} // namespace
+
+// By default a policy has no state to save
+void SelectionPolicy::getState(vector<long long> &state) const {}
+
+void SelectionPolicy::setState(const vector<long long> &state) {}
+
+// By default a policy picks the same whatever the plan looks like
+const FacilityType& SelectionPolicy::selectFacilityFor(const FacilityCatalog &facilitiesOptions, const SelectionContext &context) {
+    return selectFacility(facilitiesOptions);
+}
+
+// By default a policy's state has a fixed length
+bool SelectionPolicy::acceptsState(const vector<long long> &state) const {
+    vector<long long> own;
+    getState(own);
+    return own.size() == state.size();
+}
+
+// Most policies can pick from any category
+bool SelectionPolicy::pickedCategory(FacilityCategory &category) const {
+    return false;
+}
+
+// By default a policy can't prove its picks repeat, so plans step it for real
+bool SelectionPolicy::getCycleState(vector<long long> &key, vector<long long> &counters) const {
+    return false;
+}
+
+void SelectionPolicy::skipCycles(const vector<long long> &counterDeltas) {}
 
 // NaiveSelection Constructor
 NaiveSelection::NaiveSelection() 
 : lastSelectedIndex(-1) {}
 
 // NaiveSelection selectFacility Implementation
-const FacilityType& NaiveSelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& NaiveSelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
     lastSelectedIndex = (lastSelectedIndex + 1) % facilitiesOptions.size();
     return facilitiesOptions[lastSelectedIndex];
 }
@@ -23,35 +168,34 @@ NaiveSelection* NaiveSelection::clone() const {
     return new NaiveSelection(*this);
 }
 
+void NaiveSelection::getState(vector<long long> &state) const {
+    state.push_back(lastSelectedIndex);
+}
+
+void NaiveSelection::setState(const vector<long long> &state) {
+    lastSelectedIndex = static_cast<int>(state[0]);
+}
+
+// NaiveSelection picks depend only on where the round robin stopped
+bool NaiveSelection::getCycleState(vector<long long> &key, vector<long long> &counters) const {
+    key.push_back(lastSelectedIndex);
+    return true;
+}
+
 // BalancedSelection Constructor
 BalancedSelection::BalancedSelection(int LifeQualityScore, int EconomyScore, int EnvironmentScore)
     : LifeQualityScore(LifeQualityScore), EconomyScore(EconomyScore), EnvironmentScore(EnvironmentScore) {}
 
 // BalancedSelection selectFacility Implementation
-const FacilityType& BalancedSelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& BalancedSelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
     if (facilitiesOptions.empty()) {
         throw std::runtime_error("No facilities available for Balanced Selection.");
     }
     
-    int bestScore = std::numeric_limits<int>::max();
-    size_t bestIndex = -1;
-
-    for (size_t i = 0; i < facilitiesOptions.size(); ++i) {
-        const FacilityType& facility = facilitiesOptions[i];
-
-        // Calculate the maximum distance between scores
-        int distance1 = std::abs(facility.getLifeQualityScore() + LifeQualityScore - facility.getEnvironmentScore() - EnvironmentScore);
-        int distance2 = std::abs(facility.getLifeQualityScore() + LifeQualityScore - facility.getEconomyScore() - EconomyScore);
-        int distance3 = std::abs(facility.getEnvironmentScore() + EnvironmentScore - facility.getEconomyScore() - EconomyScore);
-
-        int maxDistance = std::max(distance1, std::max(distance2, distance3));
-
-        // Select the facility with the lowest max distance
-        if (maxDistance < bestScore) {
-            bestScore = maxDistance;
-            bestIndex = i;
-        }
-    }
+    const BalancedIndex *index = facilitiesOptions.balancedIndex();
+    size_t bestIndex = index != nullptr
+        ? index->findBest(LifeQualityScore, EconomyScore, EnvironmentScore)
+        : BalancedScan::findBest(facilitiesOptions, LifeQualityScore, EconomyScore, EnvironmentScore);
     LifeQualityScore += facilitiesOptions[bestIndex].getLifeQualityScore();
     EconomyScore += facilitiesOptions[bestIndex].getEconomyScore();
     EnvironmentScore += facilitiesOptions[bestIndex].getEnvironmentScore();
@@ -68,26 +212,50 @@ BalancedSelection* BalancedSelection::clone() const {
     return new BalancedSelection(*this);
 }
 
+void BalancedSelection::getState(vector<long long> &state) const {
+    state.push_back(LifeQualityScore);
+    state.push_back(EconomyScore);
+    state.push_back(EnvironmentScore);
+}
+
+void BalancedSelection::setState(const vector<long long> &state) {
+    LifeQualityScore = static_cast<int>(state[0]);
+    EconomyScore = static_cast<int>(state[1]);
+    EnvironmentScore = static_cast<int>(state[2]);
+}
+
+// BalancedSelection picks depend only on the differences between the scores
+bool BalancedSelection::getCycleState(vector<long long> &key, vector<long long> &counters) const {
+    key.push_back(static_cast<long long>(LifeQualityScore) - EnvironmentScore);
+    key.push_back(static_cast<long long>(LifeQualityScore) - EconomyScore);
+    counters.push_back(LifeQualityScore);
+    counters.push_back(EconomyScore);
+    counters.push_back(EnvironmentScore);
+    return true;
+}
+
+void BalancedSelection::skipCycles(const vector<long long> &counterDeltas) {
+    LifeQualityScore = static_cast<int>(LifeQualityScore + counterDeltas[0]);
+    EconomyScore = static_cast<int>(EconomyScore + counterDeltas[1]);
+    EnvironmentScore = static_cast<int>(EnvironmentScore + counterDeltas[2]);
+}
+
 // EconomySelection Constructor
 EconomySelection::EconomySelection()
-: lastSelectedIndex(-1) {}
+: lastSelectedIndex(-1), categoryPosition(0) {}
 
 // EconomySelection selectFacility Implementation
-const FacilityType& EconomySelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& EconomySelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
     if (facilitiesOptions.empty()) {
         throw std::runtime_error("No facilities available for Economy Selection.");
     }
 
-    for (size_t i = 0; i < facilitiesOptions.size(); ++i) {
-        size_t index = (lastSelectedIndex + 1 + i) % facilitiesOptions.size();
-        const FacilityType& facility = facilitiesOptions[index];
-        if (facility.getCategory() == FacilityCategory::ECONOMY) {
-            lastSelectedIndex = index;
-            return facility;
-        }
+    size_t index = facilitiesOptions.nextInCategory(FacilityCategory::ECONOMY, lastSelectedIndex, categoryPosition);
+    if (index == SIZE_MAX) {
+        throw std::runtime_error("No matching facility found for Economy Selection.");
     }
-
-    throw std::runtime_error("No matching facility found for Economy Selection.");
+    lastSelectedIndex = static_cast<int>(index);
+    return facilitiesOptions[index];
 }
 
 // EconomySelection toString Implementation
@@ -100,26 +268,41 @@ EconomySelection* EconomySelection::clone() const {
     return new EconomySelection(*this);
 }
 
+void EconomySelection::getState(vector<long long> &state) const {
+    state.push_back(lastSelectedIndex);
+}
+
+void EconomySelection::setState(const vector<long long> &state) {
+    lastSelectedIndex = static_cast<int>(state[0]);
+}
+
+// EconomySelection picks depend only on where the round robin stopped
+bool EconomySelection::getCycleState(vector<long long> &key, vector<long long> &counters) const {
+    key.push_back(lastSelectedIndex);
+    return true;
+}
+
+bool EconomySelection::pickedCategory(FacilityCategory &category) const {
+    category = FacilityCategory::ECONOMY;
+    return true;
+}
+
 // SustainabilitySelection Constructor
 SustainabilitySelection::SustainabilitySelection() 
-: lastSelectedIndex(-1) {}
+: lastSelectedIndex(-1), categoryPosition(0) {}
 
 // SustainabilitySelection selectFacility Implementation
-const FacilityType& SustainabilitySelection::selectFacility(const vector<FacilityType>& facilitiesOptions) {
+const FacilityType& SustainabilitySelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
     if (facilitiesOptions.empty()) {
         throw std::runtime_error("No facilities available for Sustainability Selection.");
     }
 
-    for (size_t i = 0; i < facilitiesOptions.size(); ++i) {
-        size_t index = (lastSelectedIndex + 1 + i) % facilitiesOptions.size();
-        const FacilityType& facility = facilitiesOptions[index];
-        if (facility.getCategory() == FacilityCategory::ENVIRONMENT) {
-            lastSelectedIndex = index;
-            return facility;
-        }
+    size_t index = facilitiesOptions.nextInCategory(FacilityCategory::ENVIRONMENT, lastSelectedIndex, categoryPosition);
+    if (index == SIZE_MAX) {
+        throw std::runtime_error("No matching facility found for Sustainability Selection.");
     }
-
-    throw std::runtime_error("No matching facility found for Sustainability Selection.");
+    lastSelectedIndex = static_cast<int>(index);
+    return facilitiesOptions[index];
 }
 
 // SustainabilitySelection toString Implementation
@@ -131,3 +314,453 @@ const string SustainabilitySelection::toString() const {
 SustainabilitySelection* SustainabilitySelection::clone() const {
     return new SustainabilitySelection(*this);
 }
+
+void SustainabilitySelection::getState(vector<long long> &state) const {
+    state.push_back(lastSelectedIndex);
+}
+
+void SustainabilitySelection::setState(const vector<long long> &state) {
+    lastSelectedIndex = static_cast<int>(state[0]);
+}
+
+// SustainabilitySelection picks depend only on where the round robin stopped
+bool SustainabilitySelection::getCycleState(vector<long long> &key, vector<long long> &counters) const {
+    key.push_back(lastSelectedIndex);
+    return true;
+}
+
+bool SustainabilitySelection::pickedCategory(FacilityCategory &category) const {
+    category = FacilityCategory::ENVIRONMENT;
+    return true;
+}
+
+// WeightedSelection Constructor
+WeightedSelection::WeightedSelection(const string &name, double lifeQualityWeight, double economyWeight, double environmentWeight)
+    : name(name), lifeQualityWeight(lifeQualityWeight), economyWeight(economyWeight), environmentWeight(environmentWeight),
+      order(), picks(), candidates(), candidatesValid(true), nextUnpicked(0) {}
+
+WeightedSelection *WeightedSelection::fromWeights(const string &weights) {
+    double values[3];
+    size_t begin = 0;
+    for (int i = 0; i < 3; i++) {
+        size_t end = i < 2 ? weights.find(',', begin) : weights.size();
+        if (end == string::npos || end == begin) {
+            return nullptr;
+        }
+        string text = weights.substr(begin, end - begin);
+        char *parsedEnd = nullptr;
+        values[i] = std::strtod(text.c_str(), &parsedEnd);
+        if (*parsedEnd != '\0' || !std::isfinite(values[i])) {
+            return nullptr;
+        }
+        begin = end + 1;
+    }
+    return new WeightedSelection("w:" + weights, values[0], values[1], values[2]);
+}
+
+bool WeightedSelection::Candidate::operator<(const Candidate &other) const {
+    return value < other.value || (value == other.value && index > other.index);
+}
+
+double WeightedSelection::valueOf(size_t index, long long picked) const {
+    double value = order->valueOf(index);
+    double divisor = static_cast<double>(picked) + 1;
+    return value >= 0 ? value / divisor : value * divisor;
+}
+
+vector<std::pair<size_t, long long>>::iterator WeightedSelection::findPicks(size_t index) {
+    return std::lower_bound(picks.begin(), picks.end(), std::make_pair(index, 0LL),
+        [](const std::pair<size_t, long long> &a, const std::pair<size_t, long long> &b) { return a.first < b.first; });
+}
+
+// WeightedSelection selectFacility Implementation
+const FacilityType& WeightedSelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
+    if (facilitiesOptions.empty()) {
+        throw std::runtime_error("No facilities available for Weighted Selection.");
+    }
+
+    if (!order || !order->isFor(facilitiesOptions)) {
+        order = facilitiesOptions.weightedOrder(lifeQualityWeight, economyWeight, environmentWeight);
+        candidatesValid = false;
+    }
+    if (!candidatesValid) {
+        // Types past the end of the catalog, as after a restore, are forgotten
+        picks.erase(findPicks(order->size()), picks.end());
+        candidates.clear();
+        for (const std::pair<size_t, long long> &picked : picks) {
+            candidates.push_back(Candidate{valueOf(picked.first, picked.second), picked.first});
+        }
+        std::make_heap(candidates.begin(), candidates.end());
+        candidatesValid = true;
+        nextUnpicked = 0;
+    }
+    while (nextUnpicked < order->size()) {
+        vector<std::pair<size_t, long long>>::iterator found = findPicks(order->at(nextUnpicked));
+        if (found == picks.end() || found->first != order->at(nextUnpicked)) {
+            break;
+        }
+        nextUnpicked++;
+    }
+
+    if (nextUnpicked < order->size()) {
+        Candidate unpicked = {order->valueOf(order->at(nextUnpicked)), order->at(nextUnpicked)};
+        if (candidates.empty() || candidates.front() < unpicked) {
+            picks.insert(findPicks(unpicked.index), std::make_pair(unpicked.index, 1LL));
+            candidates.push_back(Candidate{valueOf(unpicked.index, 1), unpicked.index});
+            std::push_heap(candidates.begin(), candidates.end());
+            nextUnpicked++;
+            return facilitiesOptions[unpicked.index];
+        }
+    }
+    std::pop_heap(candidates.begin(), candidates.end());
+    Candidate &best = candidates.back();
+    long long &picked = findPicks(best.index)->second;
+    picked++;
+    best.value = valueOf(best.index, picked);
+    size_t bestIndex = best.index;
+    std::push_heap(candidates.begin(), candidates.end());
+    return facilitiesOptions[bestIndex];
+}
+
+// WeightedSelection toString Implementation
+const string WeightedSelection::toString() const {
+    return name;
+}
+
+// WeightedSelection clone Implementation
+WeightedSelection* WeightedSelection::clone() const {
+    return new WeightedSelection(*this);
+}
+
+void WeightedSelection::getState(vector<long long> &state) const {
+    for (const std::pair<size_t, long long> &picked : picks) {
+        state.push_back(static_cast<long long>(picked.first));
+        state.push_back(picked.second);
+    }
+}
+
+void WeightedSelection::setState(const vector<long long> &state) {
+    picks.clear();
+    for (size_t i = 0; i + 1 < state.size(); i += 2) {
+        picks.push_back(std::make_pair(static_cast<size_t>(state[i]), state[i + 1]));
+    }
+    candidatesValid = false;
+}
+
+// A type and a pick count for each type picked, by type
+bool WeightedSelection::acceptsState(const vector<long long> &state) const {
+    if (state.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < state.size(); i += 2) {
+        if (state[i] < 0 || (i > 0 && state[i] <= state[i - 2]) || state[i + 1] <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The search behind LookaheadSelection, with the candidates and the
+// transposition cache it keeps from pick to pick
+class LookaheadSelection::Search {
+    public:
+        Search(const FacilityCatalog &catalog, int constructionLimit);
+        Search(const Search &other) = delete;
+        Search(Search &&other) = default;
+        Search &operator=(const Search &other) = delete;
+        // Whether the search was set up for this catalog, as it is now, and limit
+        bool isFor(const FacilityCatalog &catalog, int constructionLimit) const;
+        size_t pick(const SelectionContext &context, int depth); // The type to pick
+
+    private:
+        struct Pending {
+            int type;
+            long long timeLeft; // Never finishes unless positive
+            bool operator<(const Pending &other) const;
+        };
+        struct State {
+            long long scores[3];
+            vector<Pending> pending;
+        };
+        struct Outcome {
+            long long lowest;
+            long long steps;
+            long long total;
+            size_t move; // The first pick; SIZE_MAX for none yet
+            bool betterThan(const Outcome &other) const;
+        };
+
+        Search(const FacilityCatalog &catalog, int constructionLimit, const vector<size_t> &candidates);
+        // A search over the same candidates with a cache of its own, for one thread
+        Search forWorker() const;
+        Outcome explore(const State &state, int picksLeft);
+        Outcome tryCandidates(const State &state, int picksLeft, size_t first, size_t stride);
+        bool place(State &state, size_t type, long long &steps) const;
+        Outcome finish(const State &state) const;
+
+        const FacilityCatalog *catalog;
+        size_t catalogSize;
+        int constructionLimit;
+        vector<size_t> candidates; // In catalog order
+        std::unordered_map<vector<long long>, Outcome, SearchKeyHash> outcomes;
+
+        static const size_t MAX_OUTCOMES = 1 << 18;
+        // Searches smaller than this many positions stay on the calling thread
+        static const long long PARALLEL_MIN_POSITIONS = 1 << 16;
+};
+
+// Keeps the types no other type matches or beats on every score and on
+// build time. Sorted by build time, then by scores, a type can only be beaten
+// by types before it, and if by any, then by one that is kept.
+LookaheadSelection::Search::Search(const FacilityCatalog &catalog, int constructionLimit)
+    : catalog(&catalog), catalogSize(catalog.size()), constructionLimit(constructionLimit), candidates(), outcomes() {
+    const int *lifeQuality = catalog.lifeQualityScores();
+    const int *economy = catalog.economyScores();
+    const int *environment = catalog.environmentScores();
+    vector<size_t> order(catalog.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        int costA = catalog[a].getCost(), costB = catalog[b].getCost();
+        if (costA != costB) {
+            return costA < costB;
+        }
+        if (lifeQuality[a] != lifeQuality[b]) {
+            return lifeQuality[a] > lifeQuality[b];
+        }
+        if (economy[a] != economy[b]) {
+            return economy[a] > economy[b];
+        }
+        if (environment[a] != environment[b]) {
+            return environment[a] > environment[b];
+        }
+        return a < b;
+    });
+    vector<size_t> kept;
+    for (size_t type : order) {
+        // Types that never finish building are left to the search
+        if (catalog[type].getCost() <= 0) {
+            candidates.push_back(type);
+            continue;
+        }
+        bool beaten = false;
+        for (size_t other : kept) {
+            if (lifeQuality[other] >= lifeQuality[type] && economy[other] >= economy[type] &&
+                environment[other] >= environment[type]) {
+                beaten = true;
+                break;
+            }
+        }
+        if (!beaten) {
+            kept.push_back(type);
+            candidates.push_back(type);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+}
+
+LookaheadSelection::Search::Search(const FacilityCatalog &catalog, int constructionLimit, const vector<size_t> &candidates)
+    : catalog(&catalog), catalogSize(catalog.size()), constructionLimit(constructionLimit),
+      candidates(candidates), outcomes() {}
+
+LookaheadSelection::Search LookaheadSelection::Search::forWorker() const {
+    return Search(*catalog, constructionLimit, candidates);
+}
+
+bool LookaheadSelection::Search::isFor(const FacilityCatalog &catalog, int constructionLimit) const {
+    return this->catalog == &catalog && catalogSize == catalog.size() && this->constructionLimit == constructionLimit;
+}
+
+bool LookaheadSelection::Search::Pending::operator<(const Pending &other) const {
+    return type < other.type || (type == other.type && timeLeft < other.timeLeft);
+}
+
+bool LookaheadSelection::Search::Outcome::betterThan(const Outcome &other) const {
+    if (lowest != other.lowest) {
+        return lowest > other.lowest;
+    }
+    if (steps != other.steps) {
+        return steps < other.steps;
+    }
+    return total > other.total;
+}
+
+size_t LookaheadSelection::Search::pick(const SelectionContext &context, int depth) {
+    State root = {{context.lifeQuality, context.economy, context.environment}, vector<Pending>()};
+    if (context.facilities != nullptr) {
+        for (size_t i = 0; i < context.facilities->underConstructionCount(); i++) {
+            Pending pending = {context.facilities->getUnderConstructionType(i), context.facilities->getTimeLeft(i)};
+            root.pending.push_back(pending);
+        }
+    }
+
+    long long positions = 1;
+    for (int i = 0; i < depth && positions < PARALLEL_MIN_POSITIONS; i++) {
+        positions *= static_cast<long long>(candidates.size());
+    }
+    // Plans stepping in parallel already keep every thread busy
+    if (positions < PARALLEL_MIN_POSITIONS || StepEngine::inParallelRun()) {
+        return explore(root, depth).move;
+    }
+    SearchThreads &threads = SearchThreads::shared();
+    size_t threadCount = std::min(threads.size(), candidates.size());
+    if (threadCount < 2) {
+        return explore(root, depth).move;
+    }
+
+    // Worker t tries candidates t, t + threadCount, ...
+    vector<Outcome> results(threadCount);
+    threads.run(threadCount, [this, &root, &results, depth, threadCount](size_t t) {
+        Search worker = forWorker();
+        results[t] = worker.tryCandidates(root, depth, t, threadCount);
+    });
+    Outcome best = results[0];
+    for (const Outcome &result : results) {
+        if (result.betterThan(best) || (!best.betterThan(result) && result.move < best.move)) {
+            best = result;
+        }
+    }
+    return best.move;
+}
+
+// The best outcome of picksLeft more picks from state. Positions are cached
+// with their scores shifted so the lowest is 0, which changes no comparison.
+LookaheadSelection::Search::Outcome LookaheadSelection::Search::explore(const State &state, int picksLeft) {
+    if (picksLeft == 0) {
+        return finish(state);
+    }
+    long long base = std::min(state.scores[0], std::min(state.scores[1], state.scores[2]));
+    vector<Pending> pending(state.pending);
+    std::sort(pending.begin(), pending.end());
+    vector<long long> key;
+    key.reserve(4 + 2 * pending.size());
+    key.push_back(picksLeft);
+    for (long long score : state.scores) {
+        key.push_back(score - base);
+    }
+    for (const Pending &entry : pending) {
+        key.push_back(entry.type);
+        key.push_back(entry.timeLeft);
+    }
+
+    auto found = outcomes.find(key);
+    if (found != outcomes.end()) {
+        Outcome outcome = found->second;
+        outcome.lowest += base;
+        outcome.total += 3 * base;
+        return outcome;
+    }
+    Outcome best = tryCandidates(state, picksLeft, 0, 1);
+    if (outcomes.size() >= MAX_OUTCOMES) {
+        outcomes.clear();
+    }
+    Outcome cached = best;
+    cached.lowest -= base;
+    cached.total -= 3 * base;
+    outcomes.insert(std::make_pair(std::move(key), cached));
+    return best;
+}
+
+LookaheadSelection::Search::Outcome LookaheadSelection::Search::tryCandidates(const State &state, int picksLeft, size_t first, size_t stride) {
+    Outcome best = {LLONG_MIN, 0, LLONG_MIN, SIZE_MAX};
+    for (size_t i = first; i < candidates.size(); i += stride) {
+        State next(state);
+        long long steps = 0;
+        Outcome outcome = place(next, candidates[i], steps) ? explore(next, picksLeft - 1) : finish(next);
+        outcome.steps += steps;
+        outcome.move = candidates[i];
+        if (best.move == SIZE_MAX || outcome.betterThan(best)) {
+            best = outcome;
+        }
+    }
+    return best;
+}
+
+// Starts building type, then steps as the plan would until a construction
+// slot is free again. False if that never happens.
+bool LookaheadSelection::Search::place(State &state, size_t type, long long &steps) const {
+    Pending added = {static_cast<int>(type), (*catalog)[type].getCost()};
+    state.pending.push_back(added);
+    while (state.pending.size() >= static_cast<size_t>(constructionLimit)) {
+        long long wait = LLONG_MAX;
+        for (const Pending &entry : state.pending) {
+            if (entry.timeLeft > 0) {
+                wait = std::min(wait, entry.timeLeft);
+            }
+        }
+        if (wait == LLONG_MAX) {
+            return false;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < state.pending.size(); i++) {
+            Pending entry = state.pending[i];
+            if (entry.timeLeft > 0 && (entry.timeLeft -= wait) == 0) {
+                state.scores[0] += catalog->lifeQualityScores()[entry.type];
+                state.scores[1] += catalog->economyScores()[entry.type];
+                state.scores[2] += catalog->environmentScores()[entry.type];
+            } else {
+                state.pending[kept++] = entry;
+            }
+        }
+        state.pending.resize(kept);
+        steps += wait;
+    }
+    return true;
+}
+
+// The scores once everything under construction is built
+LookaheadSelection::Search::Outcome LookaheadSelection::Search::finish(const State &state) const {
+    long long scores[3] = {state.scores[0], state.scores[1], state.scores[2]};
+    long long steps = 0;
+    for (const Pending &entry : state.pending) {
+        if (entry.timeLeft > 0) {
+            scores[0] += catalog->lifeQualityScores()[entry.type];
+            scores[1] += catalog->economyScores()[entry.type];
+            scores[2] += catalog->environmentScores()[entry.type];
+            steps = std::max(steps, entry.timeLeft);
+        }
+    }
+    Outcome outcome = {std::min(scores[0], std::min(scores[1], scores[2])), steps, scores[0] + scores[1] + scores[2], SIZE_MAX};
+    return outcome;
+}
+
+// LookaheadSelection Constructor
+LookaheadSelection::LookaheadSelection(int depth) : depth(depth), search() {}
+
+LookaheadSelection::LookaheadSelection(const LookaheadSelection &other)
+    : SelectionPolicy(other), depth(other.depth), search() {}
+
+LookaheadSelection::~LookaheadSelection() {}
+
+LookaheadSelection *LookaheadSelection::fromDepth(const string &depth) {
+    if (depth.size() != 1 || depth[0] < '1' || depth[0] > '0' + MAX_DEPTH) {
+        return nullptr;
+    }
+    return new LookaheadSelection(depth[0] - '0');
+}
+
+// LookaheadSelection selectFacility Implementation
+const FacilityType& LookaheadSelection::selectFacility(const FacilityCatalog &facilitiesOptions) {
+    SelectionContext context = {0, 0, 0, 1, nullptr};
+    return selectFacilityFor(facilitiesOptions, context);
+}
+
+const FacilityType& LookaheadSelection::selectFacilityFor(const FacilityCatalog &facilitiesOptions, const SelectionContext &context) {
+    if (facilitiesOptions.empty()) {
+        throw std::runtime_error("No facilities available for Lookahead Selection.");
+    }
+    int constructionLimit = std::max(1, context.constructionLimit);
+    if (!search || !search->isFor(facilitiesOptions, constructionLimit)) {
+        search.reset(new Search(facilitiesOptions, constructionLimit));
+    }
+    return facilitiesOptions[search->pick(context, depth)];
+}
+
+// LookaheadSelection toString Implementation
+const string LookaheadSelection::toString() const {
+    return "lookahead:" + std::to_string(depth);
+}
+
+// LookaheadSelection clone Implementation
+LookaheadSelection* LookaheadSelection::clone() const {
+    return new LookaheadSelection(*this);
+}
@@ -3,9 +3,14 @@
 #include <iostream>
 
 Settlement:: Settlement(const string &name, SettlementType type)
-: name(name), type(type){}
+: name(NameTable::intern(name)), type(type){}
 
 const string & Settlement::getName() const
+{
+    return NameTable::name(name);
+}
+
+Symbol Settlement::getNameSymbol() const
 {
     return name;
 }
@@ -17,7 +22,7 @@ SettlementType Settlement::getType() const
 
 const string Settlement:: toString() const
 {
-     string toString = "Settlement Name: " + name;
+     string toString = "Settlement Name: " + getName();
 
     // Add the type to the stringstream
     switch (type) {
@@ -1,131 +1,60 @@
 #include "Simulation.h"
-#include "Auxiliary.h"
 #include "Action.h"
-#include <fstream>
+#include "SnapshotStore.h"
+#include "Checkpoint.h"
+#include "ConfigLoader.h"
+#include "MappedFile.h"
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <stdexcept>
 
-// Global Backup Variable
+// Global Backup Variables
 extern Simulation *backup;
+extern SnapshotStore snapshots;
 
 // Constructor
-Simulation::Simulation(const string &configFilePath)
-    : isRunning(false), planCounter(0), actionsLog(), settlements(), facilitiesOptions(), plans() {
-
-    std::ifstream configFile(configFilePath); 
-    if (!configFile.is_open()) {
+Simulation::Simulation(const string &configFilePath, int threadCount)
+    : isRunning(false), planCounter(0), actionsLog(), settlements(), facilitiesOptions(), plans(), leaderboard(), planStats(), stepEngine(threadCount),
+      settlementIndex(), planIndex(), facilityIndex(), commands(), unknownCommand(), policies() {
+
+    registerBuiltinCommands();
+    registerBuiltinPolicies();
+    MappedFile configFile(configFilePath);
+    if (!configFile.isOpen()) {
         throw std::runtime_error("Could not open config file: " + configFilePath);
     }
 
-    string codeLine;
-    while (getline(configFile, codeLine)) {
-        if (!codeLine.empty() && codeLine[0] != '#') {
-            vector<string> inputs = Auxiliary::parseArguments(codeLine);
-
-            if (!inputs.empty()) {
-                if (inputs[0] == "settlement") {
-                    int categorynum = std::stoi(inputs[2]);
-                    SettlementType type;
-                    if (categorynum == 0) {
-                        type = SettlementType::VILLAGE;
-                    } else if (categorynum == 1) {
-                        type = SettlementType::CITY;
-                    } else {
-                        type = SettlementType::METROPOLIS;
-                    }
-
-                    string name = inputs[1];
-                    // settlements.push_back(new Settlement(name, type));
-                    addSettlement(new Settlement(name,type));
-                } 
-                else if (inputs[0] == "facility") {
-                    string name = inputs[1];
-                    int categorynum = std::stoi(inputs[2]);
-                    FacilityCategory category;
-
-                    if (categorynum == 0) {
-                        category = FacilityCategory::LIFE_QUALITY;
-                    } else if (categorynum == 1) {
-                        category = FacilityCategory::ECONOMY;
-                    } else {
-                        category = FacilityCategory::ENVIRONMENT;
-                    }
-
-                    int price = std::stoi(inputs[3]);
-                    int lifeQuality = std::stoi(inputs[4]);
-                    int economy = std::stoi(inputs[5]);
-                    int environment = std::stoi(inputs[6]);
-
-                    facilitiesOptions.push_back(FacilityType(name, category, price, lifeQuality, economy, environment));
-                } 
-                else if (inputs[0] == "plan") {
-                    string Settlement_name = inputs[1];
-                    string policy = inputs[2];
-                    SelectionPolicy* selectionPolicy = nullptr;
-                    if (inputs[2] == "nve") {
-                        selectionPolicy = new NaiveSelection();
-                    } else if (inputs[2] == "bal") {
-                        selectionPolicy = new BalancedSelection(0, 0, 0); 
-                    } else if (inputs[2] == "eco") {
-                        selectionPolicy = new EconomySelection();
-                    } else {
-                        selectionPolicy = new SustainabilitySelection();
-                    }
-
-                    addPlan(getSettlement(Settlement_name),selectionPolicy);
-                }
-            }
-        }
-    }
-    configFile.close();
+    ConfigLoader::load(*this, configFile.data(), configFile.size(), threadCount);
 }
 
 // Destructor
-Simulation::~Simulation() {
-    for (BaseAction *action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear();
-    for (Settlement *settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear();
-}
+Simulation::~Simulation() {}
 
 
 // Copy Constructor
+// Plans share their built facilities, and the simulation shares its actions
+// log and settlements, with the original. So a copy costs one plan copy per
+// plan rather than a deep copy of everything built and logged so far.
 Simulation::Simulation(const Simulation &other)
     : isRunning(other.isRunning),
       planCounter(other.planCounter),
-      actionsLog(),              
-      settlements(),        
-      facilitiesOptions(), 
-      plans()
-       { 
-
-
-        // Deep copy actionsLog
-        for (BaseAction *action : other.actionsLog) {
-            actionsLog.push_back(action->clone());
-        }
-
-        // Deep copy settlements
-        for (Settlement *settlement : other.settlements) {
-            settlements.push_back(new Settlement(*settlement));
-        }
-
-        for (FacilityType facility : other.facilitiesOptions) {
-            facilitiesOptions.push_back(facility);
-        }
-
-        for(const Plan &plan : other.plans){
-        plans.push_back(Plan(plan,getSettlement(plan.getSettlement().getName())));
-        }
-        
-    }
+      actionsLog(other.actionsLog),
+      settlements(other.settlements),
+      facilitiesOptions(other.facilitiesOptions),
+      plans(other.plans),
+      leaderboard(other.leaderboard),
+      planStats(other.planStats),
+      stepEngine(other.stepEngine),
+      settlementIndex(other.settlementIndex),
+      planIndex(other.planIndex),
+      facilityIndex(other.facilityIndex),
+      commands(other.commands),
+      unknownCommand(),
+      policies(other.policies) {}
 
 
 
@@ -134,13 +63,23 @@ Simulation::Simulation(const Simulation &other)
 Simulation::Simulation(Simulation &&other) noexcept
     : isRunning(other.isRunning),
       planCounter(other.planCounter),
-      actionsLog(std::move(other.actionsLog)),
+      actionsLog(other.actionsLog),
       settlements(std::move(other.settlements)),
       facilitiesOptions(std::move(other.facilitiesOptions)),
-      plans(std::move(other.plans)) {
+      plans(std::move(other.plans)),
+      leaderboard(std::move(other.leaderboard)),
+      planStats(std::move(other.planStats)),
+      stepEngine(other.stepEngine),
+      settlementIndex(std::move(other.settlementIndex)),
+      planIndex(std::move(other.planIndex)),
+      facilityIndex(std::move(other.facilityIndex)),
+      commands(std::move(other.commands)),
+      unknownCommand(),
+      policies(std::move(other.policies)) {
 
     other.isRunning = false;
     other.planCounter = 0;
+    other.actionsLog.clear();
 }
 
 
@@ -152,32 +91,21 @@ Simulation& Simulation::operator=(const Simulation& other) {
     }
     isRunning = other.isRunning;
     planCounter = other.planCounter;
-    // Clean up existing data
-    for (BaseAction* action : actionsLog) {
-        delete action;
-    }
-    actionsLog.clear();
-    for (BaseAction* action : other.actionsLog) {
-        actionsLog.push_back(action->clone());
-    }
+    stepEngine = other.stepEngine;
+    actionsLog = other.actionsLog;
+    settlements = other.settlements;
 
-    for (Settlement* settlement : settlements) {
-        delete settlement;
-    }
-    settlements.clear();
-    for (Settlement* settlement : other.settlements) {
-        settlements.push_back(new Settlement(*settlement));
-    }
+    facilitiesOptions = other.facilitiesOptions;
 
-    facilitiesOptions.clear();
-    for (const FacilityType& facility : other.facilitiesOptions) {
-        facilitiesOptions.push_back(FacilityType(facility)); // Store pointer to facility
-    }
+    // Plans refer to settlements and facility types by index, so they are
+    // assigned as they are
+    plans = other.plans;
+    leaderboard = other.leaderboard;
+    planStats = other.planStats;
 
-    plans.clear();
-    for(const Plan &plan : other.plans){
-        plans.push_back(Plan(plan,getSettlement(plan.getSettlement().getName())));
-    }
+    settlementIndex = other.settlementIndex;
+    planIndex = other.planIndex;
+    facilityIndex = other.facilityIndex;
 
     return *this;
 }
@@ -190,27 +118,26 @@ Simulation &Simulation::operator=(Simulation &&other) noexcept {
         return *this;
     }
 
-    for (BaseAction *action : actionsLog) {
-        delete action;
-    }
-    for (Settlement *settlement : settlements) {
-        delete settlement;
-    }
-
-    actionsLog.clear();
     plans.clear();
     settlements.clear();
     facilitiesOptions.clear();
 
     isRunning = other.isRunning;
     planCounter = other.planCounter;
-    actionsLog = std::move(other.actionsLog);
+    actionsLog = other.actionsLog;
     settlements = std::move(other.settlements);
     facilitiesOptions = std::move(other.facilitiesOptions);
     plans = std::move(other.plans);
+    leaderboard = std::move(other.leaderboard);
+    planStats = std::move(other.planStats);
+    stepEngine = other.stepEngine;
+    settlementIndex = std::move(other.settlementIndex);
+    planIndex = std::move(other.planIndex);
+    facilityIndex = std::move(other.facilityIndex);
 
     other.isRunning = false;
     other.planCounter = 0;
+    other.actionsLog.clear();
 
     return *this;
 }
@@ -221,203 +148,388 @@ Simulation &Simulation::operator=(Simulation &&other) noexcept {
 void Simulation::start() {
     isRunning = true; // Update the state of the simulation
     open();
-    std::cout << "The simulation has started" << std::endl;
+    std::cout << "The simulation has started" << '\n';
 
-    while (true) {
+    std::string input;
+    do {
         std::cout << ">";
-        std::string input;
         std::getline(std::cin, input);
+    } while (runCommand(input));
+}
 
-        std::istringstream iss(input);
-        std::string command;
-        iss >> command;
-
-        try {
-            if (command == "step") {
-                int steps;
-                iss >> steps;
-                if (iss.fail() || steps <= 0) {
-                    throw std::runtime_error("Invalid input: steps must be a positive integer.");
-                }
-                BaseAction *action = new SimulateStep(steps);
-                action->act(*this);
-                addAction(action);
-            } else if (command == "plan") {
-                std::string settlementName, selectionPolicy;
-                iss >> settlementName >> selectionPolicy;
-                if (settlementName.empty() || !isSettlementExists(settlementName)) {
-                    throw std::runtime_error("Cannot create this plan");
-                }
-                BaseAction *action = new AddPlan(settlementName, selectionPolicy);
-                action->act(*this);
-                addAction(action);
-            } else if (command == "settlement") {
-                std::string settlementName;
-                int settlementTypeInt;
-                iss >> settlementName >> settlementTypeInt;
-                if (settlementName.empty() || iss.fail()) {
-                    throw std::runtime_error("missing or invalid arguments for settlement.");
-                }
-                if(isSettlementExists(settlementName)){
-                    throw std::runtime_error("Settlement already exists");
-                }
-                SettlementType settlementType = static_cast<SettlementType>(settlementTypeInt);
-                BaseAction *action = new AddSettlement(settlementName, settlementType);
-                action->act(*this);
-                addAction(action);
-
-            } else if (command == "facility") {
-                std::string facilityName;
-                int price, category, lifeQualityScore, economyScore, environmentScore;
-                iss >> facilityName >> category >> price >> lifeQualityScore >> economyScore >> environmentScore;
-                if (facilityName.empty() || category < 0 || category > 2 || price < 0 || lifeQualityScore < 0 || economyScore < 0 || environmentScore < 0) {
-                    throw std::runtime_error("invalid arguments for facility.");
-                }
-                if(isFacilityExist(facilityName)){
-                    throw std::runtime_error("Facility already exists");
-                }
-                FacilityCategory facilityCategory = static_cast<FacilityCategory>(category);
-                BaseAction *action = new AddFacility(facilityName, facilityCategory, price, lifeQualityScore, economyScore, environmentScore);
-                action->act(*this);
-                addAction(action);
-
-            } else if (command == "planStatus") {
-                int planID;
-                iss >> planID;
-                if (!planExists(planID)) {
-                    throw std::runtime_error("Plan doesn't exist");
-                }
-                BaseAction *action = new PrintPlanStatus(planID);
-                action->act(*this);
-                addAction(action);
-            } else if (command == "changePolicy") {
-                int planID;
-                std::string selectionPolicy;
-                iss >> planID >> selectionPolicy;
-                if (!planExists(planID) || !(selectionPolicy == "nve" || selectionPolicy == "bal" || selectionPolicy == "eco" || selectionPolicy == "env")) {
-                    throw std::runtime_error("invalid arguments for changePolicy");
-                }
-                if(getPlan(planID).getSelectionPolicy()->toString() == selectionPolicy){
-                    throw std::runtime_error("Cannot change selection policy");
-                }
-                BaseAction *action = new ChangePlanPolicy(planID, selectionPolicy);
-                action->act(*this);
-                addAction(action);
-            } else if (command == "log") {
-                BaseAction *action = new PrintActionsLog();
-                action->act(*this);
-                addAction(action);
-            } else if (command == "close") {
-                BaseAction *action = new Close();
-                action->act(*this);
-                addAction(action);
-                break; // Exit the loop to terminate the simulation
-            } else if (command == "backup") {
-                BaseAction *action = new BackupSimulation();
-                action->act(*this);
-                addAction(action);
-            } else if (command == "restore") {
-                if(backup == nullptr){
-                    throw std::runtime_error("No backup available");
-                }
-                BaseAction *action = new RestoreSimulation();
-                action->act(*this);
-                addAction(action);
-            } else {
-                std::cout << "Unknown command: " << command << std::endl;
-            }
-        } catch (const std::exception &e) {
-            std::cout << "Error: " << e.what() << std::endl;
+// Runs every line of a command file the way start() runs typed commands, but
+// without prompts. The simulation stops at a close command or at the end of
+// the file.
+void Simulation::startBatch(const string &commandFilePath) {
+    MappedFile commandFile(commandFilePath);
+    if (!commandFile.isOpen()) {
+        throw std::runtime_error("Could not open command file: " + commandFilePath);
+    }
+    isRunning = true;
+    open();
+    std::cout << "The simulation has started" << '\n';
+
+    const char *position = commandFile.data();
+    const char *end = position + commandFile.size();
+    std::string input; // Reused for every line
+    while (position != end) {
+        const char *newline = static_cast<const char *>(std::memchr(position, '\n', end - position));
+        input.assign(position, newline != nullptr ? newline : end);
+        position = newline != nullptr ? newline + 1 : end;
+        if (!runCommand(input)) {
+            break;
+        }
+    }
+}
+
+// Runs one command line; false once the simulation was closed
+bool Simulation::runCommand(const string &input) {
+    try {
+        if (!commands.dispatch(*this, input, unknownCommand)) {
+            std::cout << "Unknown command: " << unknownCommand << '\n';
         }
+    } catch (const std::exception &e) {
+        std::cout << "Error: " << e.what() << '\n';
     }
+    return isRunning;
+}
+
+void Simulation::registerCommand(const string &name, const string &argumentSpec, const CommandHandler &handler) {
+    commands.add(name, argumentSpec, handler);
+}
+
+void Simulation::runAction(BaseAction &action) {
+    action.act(*this);
+    addAction(action);
+}
+
+void Simulation::registerPolicy(const string &name, const PolicyFactory &factory) {
+    policies.add(name, factory);
+}
+
+SelectionPolicy *Simulation::createPolicy(const string &name, int lifeQuality, int economy, int environment) const {
+    return policies.create(name, lifeQuality, economy, environment);
+}
+
+bool Simulation::canPickWith(const SelectionPolicy &selectionPolicy) const {
+    FacilityCategory category;
+    return !selectionPolicy.pickedCategory(category) || facilitiesOptions.hasCategory(category);
 }
-            
 
-void Simulation:: addPlan(const Settlement &settlement, SelectionPolicy *selectionPolicy) {
-    // Construct the Plan object
-    Plan newPlan(planCounter, settlement, selectionPolicy, facilitiesOptions);
+void Simulation::registerBuiltinPolicies() {
+    policies.add("nve", [](const string &, int, int, int) -> SelectionPolicy * {
+        return new NaiveSelection();
+    });
+    // A plan switching to bal carries on from the scores it already has
+    policies.add("bal", [](const string &, int lifeQuality, int economy, int environment) -> SelectionPolicy * {
+        return new BalancedSelection(lifeQuality, economy, environment);
+    });
+    policies.add("eco", [](const string &, int, int, int) -> SelectionPolicy * {
+        return new EconomySelection();
+    });
+    policies.add("env", [](const string &, int, int, int) -> SelectionPolicy * {
+        return new SustainabilitySelection();
+    });
+    policies.add("w:", [](const string &weights, int, int, int) -> SelectionPolicy * {
+        return WeightedSelection::fromWeights(weights);
+    });
+    policies.add("lookahead:", [](const string &depth, int, int, int) -> SelectionPolicy * {
+        return LookaheadSelection::fromDepth(depth);
+    });
+}
+
+void Simulation::registerBuiltinCommands() {
+    commands.add("step", "i", [](Simulation &simulation, const CommandArgs &args) {
+        if (!args.isInt(0) || args.integer(0) <= 0) {
+            throw std::runtime_error("Invalid input: steps must be a positive integer.");
+        }
+        SimulateStep action(args.integer(0));
+        simulation.runAction(action);
+    });
+    commands.add("plan", "ww", [](Simulation &simulation, const CommandArgs &args) {
+        const string &settlementName = args.word(0);
+        if (settlementName.empty() || !simulation.isSettlementExists(settlementName)) {
+            throw std::runtime_error("Cannot create this plan");
+        }
+        std::unique_ptr<SelectionPolicy> selectionPolicy(simulation.createPolicy(args.word(1)));
+        if (!selectionPolicy) {
+            throw std::runtime_error("Cannot create this plan: unknown selection policy");
+        }
+        if (!simulation.canPickWith(*selectionPolicy)) {
+            throw std::runtime_error("Cannot create this plan: no facility type in its policy's category");
+        }
+        AddPlan action(settlementName, args.word(1));
+        simulation.runAction(action);
+    });
+    commands.add("settlement", "wi", [](Simulation &simulation, const CommandArgs &args) {
+        const string &settlementName = args.word(0);
+        if (settlementName.empty() || !args.isInt(1)) {
+            throw std::runtime_error("missing or invalid arguments for settlement.");
+        }
+        if (simulation.isSettlementExists(settlementName)) {
+            throw std::runtime_error("Settlement already exists");
+        }
+        AddSettlement action(settlementName, static_cast<SettlementType>(args.integer(1)));
+        simulation.runAction(action);
+    });
+    commands.add("facility", "wiiiii", [](Simulation &simulation, const CommandArgs &args) {
+        const string &facilityName = args.word(0);
+        bool valid = !facilityName.empty();
+        for (size_t i = 1; i <= 5; i++) {
+            valid = valid && args.isInt(i) && args.integer(i) >= 0;
+        }
+        if (!valid || args.integer(1) > 2) {
+            throw std::runtime_error("invalid arguments for facility.");
+        }
+        if (simulation.isFacilityExist(facilityName)) {
+            throw std::runtime_error("Facility already exists");
+        }
+        AddFacility action(facilityName, static_cast<FacilityCategory>(args.integer(1)),
+            args.integer(2), args.integer(3), args.integer(4), args.integer(5));
+        simulation.runAction(action);
+    });
+    commands.add("planStatus", "i", [](Simulation &simulation, const CommandArgs &args) {
+        if (!args.isInt(0) || !simulation.planExists(args.integer(0))) {
+            throw std::runtime_error("Plan doesn't exist");
+        }
+        PrintPlanStatus action(args.integer(0));
+        simulation.runAction(action);
+    });
+    commands.add("changePolicy", "iw", [](Simulation &simulation, const CommandArgs &args) {
+        const string &selectionPolicy = args.word(1);
+        std::unique_ptr<SelectionPolicy> policy(simulation.createPolicy(selectionPolicy));
+        if (!args.isInt(0) || !simulation.planExists(args.integer(0)) || !policy) {
+            throw std::runtime_error("invalid arguments for changePolicy");
+        }
+        if (simulation.getPlan(args.integer(0)).getSelectionPolicy()->toString() == selectionPolicy) {
+            throw std::runtime_error("Cannot change selection policy");
+        }
+        if (!simulation.canPickWith(*policy)) {
+            throw std::runtime_error("Cannot change selection policy: no facility type in its category");
+        }
+        ChangePlanPolicy action(args.integer(0), selectionPolicy);
+        simulation.runAction(action);
+    });
+    // log, log <from> <to> for entries [from, to), or log tail <count>
+    commands.add("log", "ww", [](Simulation &simulation, const CommandArgs &args) {
+        if (args.word(0).empty()) {
+            PrintActionsLog action;
+            simulation.runAction(action);
+            return;
+        }
+        int first, second;
+        if (!CommandArgs::toInt(args.word(1), second) || second < 0) {
+            throw std::runtime_error("invalid arguments for log");
+        }
+        if (args.word(0) == "tail") {
+            PrintActionsLog action = PrintActionsLog::tail(second);
+            simulation.runAction(action);
+        } else if (CommandArgs::toInt(args.word(0), first) && first >= 0 && first <= second) {
+            PrintActionsLog action(first, second);
+            simulation.runAction(action);
+        } else {
+            throw std::runtime_error("invalid arguments for log");
+        }
+    });
+    commands.add("top", "iw", [](Simulation &simulation, const CommandArgs &args) {
+        Leaderboard::Metric metric;
+        if (!args.isInt(0) || args.integer(0) <= 0 || !Leaderboard::parseMetric(args.word(1), metric)) {
+            throw std::runtime_error("invalid arguments for top");
+        }
+        PrintLeaderboard action(args.integer(0), metric);
+        simulation.runAction(action);
+    });
+    commands.add("stats", "w", [](Simulation &simulation, const CommandArgs &args) {
+        if (!args.word(0).empty() && !simulation.isSettlementExists(args.word(0))) {
+            throw std::runtime_error("Settlement doesn't exist");
+        }
+        PrintStats action(args.word(0));
+        simulation.runAction(action);
+    });
+    commands.add("close", "", [](Simulation &simulation, const CommandArgs &) {
+        Close action;
+        simulation.runAction(action);
+    });
+    commands.add("backup", "w", [](Simulation &simulation, const CommandArgs &args) {
+        BackupSimulation action(args.word(0));
+        simulation.runAction(action);
+    });
+    commands.add("restore", "w", [](Simulation &simulation, const CommandArgs &args) {
+        const string &name = args.word(0);
+        if (name.empty() ? backup == nullptr : !simulation.backupExists(name)) {
+            throw std::runtime_error("No backup available");
+        }
+        RestoreSimulation action(name);
+        simulation.runAction(action);
+    });
+    commands.add("save", "w", [](Simulation &simulation, const CommandArgs &args) {
+        if (args.word(0).empty()) {
+            throw std::runtime_error("missing file name for save");
+        }
+        SaveCheckpoint action(args.word(0));
+        simulation.runAction(action);
+    });
+    commands.add("load", "w", [](Simulation &simulation, const CommandArgs &args) {
+        if (args.word(0).empty()) {
+            throw std::runtime_error("missing file name for load");
+        }
+        LoadCheckpoint action(args.word(0));
+        simulation.runAction(action);
+    });
+}
+
+
+void Simulation:: addPlan(size_t settlementIndex, SelectionPolicy *selectionPolicy) {
+    // Construct the Plan in place
+    planIndex.insert(std::make_pair(planCounter, plans.size()));
+    plans.emplace_back(planCounter, settlementIndex, *settlements[settlementIndex], selectionPolicy);
+    planStats.add(plans.back());
     planCounter ++;
-    // Add the Plan to the vector
-    plans.push_back(newPlan);
 }
 
-void Simulation::addAction(BaseAction *action) {
-    if (!action) {
-        throw std::runtime_error("Null action cannot be added.");
-    }
-    actionsLog.push_back(action); // Store pointer for later cleanup
+void Simulation::addAction(const BaseAction &action) {
+    actionsLog.append(action.toRecord());
 }
 
 bool Simulation:: addSettlement(Settlement *settlement){
-    settlements.push_back(settlement);
+    settlementIndex.insert(std::make_pair(settlement->getNameSymbol(), settlements.size()));
+    settlements.push_back(std::shared_ptr<Settlement>(settlement));
     return true;
 }
 
 bool Simulation:: addFacility(FacilityType facility){
+    facilityIndex.insert(std::make_pair(facility.getNameSymbol(), facilitiesOptions.size()));
     facilitiesOptions.push_back(facility);
     return true;
 }
 
 bool Simulation::isSettlementExists(const string &settlementName) {
-    // Iterate through the settlements vector
-    for (Settlement* settlement : settlements) {
-        if (settlement->getName() == settlementName) { // Assuming Settlement has a getName() method
-            return true; // Settlement found
-        }
-    }
-    return false; // Settlement not found
+    return settlementIndex.find(NameTable::find(settlementName)) != settlementIndex.end();
 }
 
 Settlement &Simulation::getSettlement(const string &settlementName) {
-    for (Settlement* settlement : settlements) {
-        if (settlement->getName() == settlementName) { // Assuming Settlement has a getName() method
-            return *settlement; // Dereference the pointer and return a reference
-        }
+    return *settlements[getSettlementIndex(settlementName)];
+}
+
+size_t Simulation::getSettlementIndex(const string &settlementName) const {
+    auto found = settlementIndex.find(NameTable::find(settlementName));
+    if (found == settlementIndex.end()) {
+        // If no settlement is found, throw an exception
+        throw std::runtime_error("Settlement not found: " + settlementName);
     }
-    // If no settlement is found, throw an exception
-    throw std::runtime_error("Settlement not found: " + settlementName);
+    return found->second;
 }
 
 Plan &Simulation::getPlan(const int planID){
-    for (Plan &plan : plans) { // Use reference to avoid copying
-        if (plan.getPlanID() == planID) {
-            return plan;
-        }
+    auto found = planIndex.find(planID);
+    if (found == planIndex.end()) {
+        // If no plan is found, throw an exception
+        throw std::runtime_error("Plan not found");
     }
-    // If no plan is found, throw an exception
-    throw std::runtime_error("Plan not found");
+    return plans[found->second];
 }
 
 bool Simulation::planExists(const int planID){
-    for (Plan &plan : plans) {
-        if (plan.getPlanID() == planID) { // Assuming Settlement has a getName() method
-            return true; // Settlement found
-        }
-    }
-    return false;
+    return planIndex.find(planID) != planIndex.end();
 }
 
 bool Simulation::isFacilityExist(const string &facilityName){
-    for(FacilityType facility : facilitiesOptions){
-        if(facility.getName() == facilityName)
-            return true;
-    }
-    return false;
+    return facilityIndex.find(NameTable::find(facilityName)) != facilityIndex.end();
 }
 
 std::vector<Plan>& Simulation::getPlans() {
     return plans;
 }
 
+const FacilityCatalog &Simulation::getFacilityCatalog() const {
+    return facilitiesOptions;
+}
+
+const PlanStats &Simulation::getPlanStats() const {
+    return planStats;
+}
+
+void Simulation::topPlans(Leaderboard::Metric metric, size_t count, vector<size_t> &positions) {
+    leaderboard.top(plans, metric, count, positions);
+}
+
 void Simulation:: step(){
-    for (Plan &plan : plans) {
-        plan.step();
+    step(1);
+}
+
+void Simulation::step(int numOfSteps){
+    facilitiesOptions.prepare();
+    try {
+        stepPlans(numOfSteps);
+    } catch (...) {
+        // Plans stepped before the failure keep their steps
+        plansChanged();
+        throw;
+    }
+    plansChanged();
+}
+
+void Simulation::plansChanged() {
+    leaderboard.update(plans);
+    planStats.update(plans);
+}
+
+void Simulation::stepPlans(int numOfSteps) {
+    if (canStepPlansIndependently()) {
+        // Plans don't affect each other, so each one can run (or fast-forward)
+        // all its steps at once
+        stepEngine.run(plans, facilitiesOptions, numOfSteps);
+        return;
+    }
+    for (int i = 0; i < numOfSteps; i++) {
+        for (Plan &plan : plans) {
+            plan.step(facilitiesOptions);
+        }
+    }
+}
+
+void Simulation::setThreadCount(int threadCount){
+    stepEngine.setThreadCount(threadCount);
+}
+
+void Simulation::rebuildIndexes() {
+    settlementIndex.clear();
+    for (size_t i = 0; i < settlements.size(); i++) {
+        settlementIndex.insert(std::make_pair(settlements[i]->getNameSymbol(), i));
+    }
+    planIndex.clear();
+    for (size_t i = 0; i < plans.size(); i++) {
+        planIndex.insert(std::make_pair(plans[i].getPlanID(), i));
     }
+    facilityIndex.clear();
+    for (size_t i = 0; i < facilitiesOptions.size(); i++) {
+        facilityIndex.insert(std::make_pair(facilitiesOptions[i].getNameSymbol(), i));
+    }
+    leaderboard.clear();
+    planStats.clear();
+    planStats.update(plans);
+}
+
+// A selection that throws stops the step in the middle, leaving earlier plans
+// one step ahead of later ones. That state can only be reproduced step by step.
+bool Simulation::canStepPlansIndependently() const {
+    if (facilitiesOptions.empty()) {
+        return false;
+    }
+    if (facilitiesOptions.hasCategory(FacilityCategory::ECONOMY) && facilitiesOptions.hasCategory(FacilityCategory::ENVIRONMENT)) {
+        return true;
+    }
+    for (const Plan &plan : plans) {
+        if (!canPickWith(*plan.getSelectionPolicy())) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void Simulation:: close(){
     for (Plan &plan : plans) {
-        std::cout << plan.shortenedToString() << std::endl;
+        std::cout << plan.shortenedToString() << '\n';
     }
     isRunning = false;
 }
@@ -426,7 +538,11 @@ void Simulation:: open(){
     isRunning = true;
 }
 
-const std::vector<BaseAction *> &Simulation::getActionsLog() const {
+void Simulation::spillActionsLog(const string &path, size_t capacity) {
+    actionsLog.spillTo(path, capacity);
+}
+
+const ActionLog &Simulation::getActionsLog() const {
     return actionsLog;
 }
 
@@ -436,7 +552,7 @@ void Simulation::backUp() {
         backup = nullptr;
     }
 
-    backup = new Simulation(*this); // Deep copy the current state
+    backup = new Simulation(*this); // Shares facilities, log and settlements with the live state
 }
 
 void Simulation::restore() {
@@ -444,7 +560,28 @@ void Simulation::restore() {
         throw std::runtime_error("No backup exists to restore from.");
     }
 
-    // Use the copy assignment operator to copy the backup state
+    // Use the copy assignment operator to copy the backup state. The backup must
+    // stay usable for the next restore, so its plans are copied (each copy
+    // shares its facilities) instead of being swapped in.
     *this = *backup;
 }
 
+void Simulation::backUp(const string &name) {
+    snapshots.save(name, *this);
+}
+
+void Simulation::restore(const string &name) {
+    snapshots.restore(name, *this);
+}
+
+bool Simulation::backupExists(const string &name) const {
+    return snapshots.contains(name);
+}
+
+void Simulation::saveCheckpoint(const string &path) const {
+    Checkpoint::save(*this, path);
+}
+
+void Simulation::loadCheckpoint(const string &path) {
+    Checkpoint::load(*this, path);
+}
@@ -0,0 +1,123 @@
+#include "SlabPool.h"
+#include <algorithm>
+#include <cstdint>
+
+const size_t SlabPool::SLAB_BYTES;
+const size_t SlabPool::MIN_BLOCKS_PER_SLAB;
+const size_t SlabPool::MAX_BATCH;
+
+namespace {
+    // Blocks are aligned for any type
+    const size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+}
+
+// A cache holds up to two batches, so batches are kept small next to a slab
+SlabPool::SlabPool(size_t blockSize, size_t blocksPerSlab)
+    : blockSize((std::max(blockSize, sizeof(FreeBlock)) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT),
+      blocksPerSlab(std::max<size_t>(1, blocksPerSlab)),
+      batch(std::max<size_t>(1, std::min(MAX_BATCH, this->blocksPerSlab / 8))),
+      slabs(), freeBlocks(nullptr), mutex() {}
+
+SlabPool::~SlabPool() {
+    for (char *slab : slabs) {
+        ::operator delete(slab);
+    }
+}
+
+void *SlabPool::allocate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBlocks == nullptr) {
+        addSlab();
+    }
+    FreeBlock *block = freeBlocks;
+    freeBlocks = block->next;
+    return block;
+}
+
+void SlabPool::release(void *block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    freed->next = freeBlocks;
+    freeBlocks = freed;
+}
+
+// Refills an empty cache with a batch under one lock
+void *SlabPool::allocate(LocalCache &cache) {
+    if (cache.retired) {
+        return allocate();
+    }
+    if (cache.blocks == nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < batch; i++) {
+            if (freeBlocks == nullptr) {
+                addSlab();
+            }
+            FreeBlock *block = freeBlocks;
+            freeBlocks = block->next;
+            block->next = cache.blocks;
+            cache.blocks = block;
+        }
+        cache.count = batch;
+    }
+    FreeBlock *block = cache.blocks;
+    cache.blocks = block->next;
+    cache.count--;
+    return block;
+}
+
+// Returns a batch to the pool once the cache holds two
+void SlabPool::release(LocalCache &cache, void *block) {
+    if (cache.retired) {
+        release(block);
+        return;
+    }
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    freed->next = cache.blocks;
+    cache.blocks = freed;
+    cache.count++;
+    if (cache.count < 2 * batch) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < batch; i++) {
+        FreeBlock *returned = cache.blocks;
+        cache.blocks = returned->next;
+        returned->next = freeBlocks;
+        freeBlocks = returned;
+    }
+    cache.count -= batch;
+}
+
+size_t SlabPool::slabCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slabs.size();
+}
+
+// Threads the new slab's blocks onto the free list, first block first
+void SlabPool::addSlab() {
+    char *slab = static_cast<char *>(::operator new(blockSize * blocksPerSlab));
+    slabs.push_back(slab);
+    for (size_t i = blocksPerSlab; i-- > 0;) {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(slab + i * blockSize);
+        block->next = freeBlocks;
+        freeBlocks = block;
+    }
+}
+
+void SlabPool::retire(LocalCache &cache) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (cache.blocks != nullptr) {
+        FreeBlock *returned = cache.blocks;
+        cache.blocks = returned->next;
+        returned->next = freeBlocks;
+        freeBlocks = returned;
+    }
+    cache.count = 0;
+    cache.retired = true;
+}
+
+SlabPool::Retirer::Retirer(SlabPool &pool, LocalCache &cache) : pool(pool), cache(cache) {}
+
+SlabPool::Retirer::~Retirer() {
+    pool.retire(cache);
+}
@@ -0,0 +1,135 @@
+#include "SnapshotStore.h"
+#include <stdexcept>
+
+namespace {
+
+bool sameFacilityType(const FacilityType &a, const FacilityType &b) {
+    return a.getName() == b.getName() && a.getCategory() == b.getCategory() && a.getCost() == b.getCost() &&
+           a.getLifeQualityScore() == b.getLifeQualityScore() && a.getEconomyScore() == b.getEconomyScore() &&
+           a.getEnvironmentScore() == b.getEnvironmentScore();
+}
+
+} // namespace
+
+SnapshotStore::Snapshot::Snapshot(const std::shared_ptr<const Snapshot> &parent)
+    : parent(parent), planCounter(0), planCount(0), changedPlanIndices(), changedPlans(),
+      keptSettlements(0), addedSettlements(), keptFacilities(0), addedFacilities(), actionsLog() {}
+
+SnapshotStore::SnapshotStore()
+    : snapshots(), head(), headSettlements(), headFacilities(), headVersions() {}
+
+void SnapshotStore::save(const string &name, const Simulation &simulation) {
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>(head);
+    snapshot->planCounter = simulation.planCounter;
+    snapshot->planCount = simulation.plans.size();
+    snapshot->actionsLog = simulation.actionsLog;
+
+    // Only plans that changed since the parent are copied
+    vector<unsigned long long> versions;
+    versions.reserve(simulation.plans.size());
+    for (size_t i = 0; i < simulation.plans.size(); i++) {
+        const Plan &plan = simulation.plans[i];
+        versions.push_back(plan.getVersion());
+        if (i >= headVersions.size() || headVersions[i] != plan.getVersion()) {
+            snapshot->changedPlanIndices.push_back(i);
+            snapshot->changedPlans.push_back(plan);
+        }
+    }
+
+    // Settlements and facility types are only ever appended, so whatever the
+    // parent has in common with the live simulation is a prefix
+    size_t kept = 0;
+    while (kept < headSettlements.size() && kept < simulation.settlements.size() &&
+           headSettlements[kept] == simulation.settlements[kept]) {
+        kept++;
+    }
+    snapshot->keptSettlements = kept;
+    snapshot->addedSettlements.assign(simulation.settlements.begin() + kept, simulation.settlements.end());
+
+    kept = 0;
+    while (kept < headFacilities.size() && kept < simulation.facilitiesOptions.size() &&
+           sameFacilityType(headFacilities[kept], simulation.facilitiesOptions[kept])) {
+        kept++;
+    }
+    snapshot->keptFacilities = kept;
+    for (size_t i = kept; i < simulation.facilitiesOptions.size(); i++) {
+        snapshot->addedFacilities.push_back(simulation.facilitiesOptions[i]);
+    }
+
+    snapshots[name] = snapshot;
+    head = snapshot;
+    headSettlements = simulation.settlements;
+    headFacilities.clear();
+    for (const FacilityType &facility : simulation.facilitiesOptions) {
+        headFacilities.push_back(facility);
+    }
+    headVersions.swap(versions);
+}
+
+void SnapshotStore::restore(const string &name, Simulation &simulation) {
+    auto found = snapshots.find(name);
+    if (found == snapshots.end()) {
+        throw std::runtime_error("No backup exists to restore from.");
+    }
+    const Snapshot &snapshot = *found->second;
+
+    vector<const Plan *> plans;
+    vector<std::shared_ptr<Settlement>> settlements;
+    vector<FacilityType> facilities;
+    materialize(snapshot, plans, settlements, facilities);
+
+    simulation.planCounter = snapshot.planCounter;
+    simulation.actionsLog = snapshot.actionsLog;
+    simulation.settlements = settlements;
+    simulation.facilitiesOptions.clear();
+    for (const FacilityType &facility : facilities) {
+        simulation.facilitiesOptions.push_back(facility);
+    }
+    simulation.plans.clear();
+    headVersions.clear();
+    for (const Plan *plan : plans) {
+        simulation.plans.push_back(*plan);
+        headVersions.push_back(plan->getVersion());
+    }
+    simulation.rebuildIndexes();
+
+    head = found->second;
+    headSettlements.swap(settlements);
+    headFacilities.swap(facilities);
+}
+
+bool SnapshotStore::contains(const string &name) const {
+    return snapshots.find(name) != snapshots.end();
+}
+
+void SnapshotStore::materialize(const Snapshot &snapshot, vector<const Plan *> &plans,
+    vector<std::shared_ptr<Settlement>> &settlements, vector<FacilityType> &facilities) {
+    vector<const Snapshot *> chain;
+    for (const Snapshot *current = &snapshot; current != nullptr; current = current->parent.get()) {
+        chain.push_back(current);
+    }
+
+    // Each plan comes from the newest snapshot that recorded it
+    plans.assign(snapshot.planCount, nullptr);
+    for (const Snapshot *current : chain) {
+        for (size_t i = 0; i < current->changedPlanIndices.size(); i++) {
+            size_t index = current->changedPlanIndices[i];
+            if (index < plans.size() && plans[index] == nullptr) {
+                plans[index] = &current->changedPlans[i];
+            }
+        }
+    }
+
+    // Settlements and facility types are replayed from the oldest snapshot on
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const Snapshot *current = *it;
+        settlements.resize(current->keptSettlements);
+        settlements.insert(settlements.end(), current->addedSettlements.begin(), current->addedSettlements.end());
+        while (facilities.size() > current->keptFacilities) {
+            facilities.pop_back();
+        }
+        for (const FacilityType &facility : current->addedFacilities) {
+            facilities.push_back(facility);
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include "StepEngine.h"
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <memory>
+#include <algorithm>
+
+namespace {
+
+// The part of the plans vector a worker still has to step: [next, end)
+struct WorkRange {
+    WorkRange() : lock(), next(0), end(0) {}
+    std::mutex lock;
+    size_t next;
+    size_t end;
+};
+
+// Takes up to GRAIN_SIZE plans from the front of the worker's own range
+bool takeOwn(WorkRange &range, size_t &begin, size_t &end) {
+    std::lock_guard<std::mutex> guard(range.lock);
+    if (range.next >= range.end) {
+        return false;
+    }
+    begin = range.next;
+    end = std::min(range.next + StepEngine::GRAIN_SIZE, range.end);
+    range.next = end;
+    return true;
+}
+
+// Moves the back half of a victim's remaining range into the thief's range
+bool steal(WorkRange &victim, WorkRange &thief) {
+    size_t begin = 0, end = 0;
+    {
+        std::lock_guard<std::mutex> guard(victim.lock);
+        size_t remaining = victim.end - victim.next;
+        if (victim.next >= victim.end || remaining < 2) {
+            return false;
+        }
+        begin = victim.next + remaining / 2;
+        end = victim.end;
+        victim.end = begin;
+    }
+    std::lock_guard<std::mutex> guard(thief.lock);
+    thief.next = begin;
+    thief.end = end;
+    return true;
+}
+
+// Set on every thread of a parallel run, the caller's included, while it works
+thread_local bool steppingInParallel = false;
+
+struct ParallelRunMark {
+    ParallelRunMark() : previous(steppingInParallel) {
+        steppingInParallel = true;
+    }
+    ~ParallelRunMark() {
+        steppingInParallel = previous;
+    }
+    bool previous;
+};
+
+void stepRange(vector<Plan> &plans, const FacilityCatalog &facilityOptions, size_t begin, size_t end, int numOfSteps) {
+    for (size_t i = begin; i < end; i++) {
+        plans[i].step(numOfSteps, facilityOptions);
+    }
+}
+
+} // namespace
+
+StepEngine::StepEngine(int threadCount)
+    : threadCount(threadCount < 1 ? 1 : threadCount) {}
+
+int StepEngine::getThreadCount() const {
+    return threadCount;
+}
+
+bool StepEngine::inParallelRun() {
+    return steppingInParallel;
+}
+
+void StepEngine::setThreadCount(int threadCount) {
+    this->threadCount = threadCount < 1 ? 1 : threadCount;
+}
+
+void StepEngine::run(vector<Plan> &plans, const FacilityCatalog &facilityOptions, int numOfSteps) const {
+    size_t workers = static_cast<size_t>(threadCount);
+    if (workers > plans.size() / GRAIN_SIZE) {
+        workers = plans.size() / GRAIN_SIZE;
+    }
+    if (workers <= 1) {
+        stepRange(plans, facilityOptions, 0, plans.size(), numOfSteps);
+        return;
+    }
+
+    // Initial even split; stealing evens out plans that take longer to step
+    std::unique_ptr<WorkRange[]> ranges(new WorkRange[workers]);
+    size_t share = plans.size() / workers;
+    for (size_t w = 0; w < workers; w++) {
+        ranges[w].next = w * share;
+        ranges[w].end = (w + 1 == workers) ? plans.size() : (w + 1) * share;
+    }
+
+    std::mutex failureLock;
+    std::exception_ptr failure;
+    size_t failureIndex = plans.size();
+
+    auto work = [&](size_t self) {
+        ParallelRunMark mark;
+        size_t begin = 0, end = 0;
+        while (true) {
+            if (!takeOwn(ranges[self], begin, end)) {
+                bool stolen = false;
+                for (size_t k = 1; k < workers && !stolen; k++) {
+                    stolen = steal(ranges[(self + k) % workers], ranges[self]);
+                }
+                if (!stolen) {
+                    return;
+                }
+                continue;
+            }
+            try {
+                stepRange(plans, facilityOptions, begin, end, numOfSteps);
+            } catch (...) {
+                // Keep the error of the first plan in plans order
+                std::lock_guard<std::mutex> guard(failureLock);
+                if (begin < failureIndex) {
+                    failureIndex = begin;
+                    failure = std::current_exception();
+                }
+            }
+        }
+    };
+
+    vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) {
+        threads.push_back(std::thread(work, w));
+    }
+    work(0);
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
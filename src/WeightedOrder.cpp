@@ -0,0 +1,40 @@
+#include "WeightedOrder.h"
+#include "FacilityCatalog.h"
+#include <algorithm>
+
+WeightedOrder::WeightedOrder(const FacilityCatalog &catalog, double lifeQualityWeight, double economyWeight, double environmentWeight)
+    : lifeQualityWeight(lifeQualityWeight), economyWeight(economyWeight), environmentWeight(environmentWeight),
+      catalogVersion(catalog.version()), values(), order() {
+    values.reserve(catalog.size());
+    order.reserve(catalog.size());
+    for (size_t i = 0; i < catalog.size(); i++) {
+        values.push_back(lifeQualityWeight * catalog.lifeQualityScores()[i]
+            + economyWeight * catalog.economyScores()[i]
+            + environmentWeight * catalog.environmentScores()[i]);
+        order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return values[a] > values[b] || (values[a] == values[b] && a < b);
+    });
+}
+
+bool WeightedOrder::hasWeights(double lifeQualityWeight, double economyWeight, double environmentWeight) const {
+    return this->lifeQualityWeight == lifeQualityWeight && this->economyWeight == economyWeight &&
+        this->environmentWeight == environmentWeight;
+}
+
+bool WeightedOrder::isFor(const FacilityCatalog &catalog) const {
+    return catalogVersion == catalog.version();
+}
+
+size_t WeightedOrder::size() const {
+    return order.size();
+}
+
+double WeightedOrder::valueOf(size_t index) const {
+    return values[index];
+}
+
+size_t WeightedOrder::at(size_t position) const {
+    return order[position];
+}
@@ -1,22 +1,74 @@
 #include "Simulation.h"
+#include "SnapshotStore.h"
 #include <iostream>
+#include <cstdlib>
+#include <exception>
 
 using namespace std;
 
 Simulation* backup = nullptr;
+SnapshotStore snapshots;
+
+// Log entries kept in memory when only --log-file is given
+const size_t DEFAULT_LOG_CAPACITY = 1 << 20;
 
 int main(int argc, char** argv){
-    if(argc!=2){
-        cout << "usage: simulation <config_path>" << endl;
+    int threads = 1;
+    string configurationFile;
+    string batchFile;
+    // Without either option the whole actions log stays in memory
+    string logFile;
+    long long logCapacity = -1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchFile = argv[++i];
+        } else if (arg == "--log-capacity" && i + 1 < argc) {
+            logCapacity = atoll(argv[++i]);
+            if (logCapacity < 0) {
+                configurationFile.clear();
+                break;
+            }
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            logFile = argv[++i];
+        } else if (configurationFile.empty() && arg.compare(0, 2, "--") != 0) {
+            configurationFile = arg;
+        } else {
+            configurationFile.clear();
+            break;
+        }
+    }
+    if(configurationFile.empty() || threads < 1){
+        cout << "usage: simulation [--threads N] [--batch <command_file>] [--log-capacity N] [--log-file <path>] <config_path>" << endl;
         return 0;
     }
-    string configurationFile = argv[1];
-    Simulation simulation(configurationFile);
-    simulation.start();
+    // Nobody reads a batch run's output as it happens, so it goes out in
+    // large blocks rather than through the small stdio buffer
+    static char outputBuffer[1 << 20];
+    if (!batchFile.empty()) {
+        ios::sync_with_stdio(false);
+        cout.rdbuf()->pubsetbuf(outputBuffer, sizeof(outputBuffer));
+    }
+    try {
+        Simulation simulation(configurationFile, threads);
+        if (!logFile.empty() || logCapacity >= 0) {
+            simulation.spillActionsLog(logFile.empty() ? "actions.log" : logFile,
+                logCapacity < 0 ? DEFAULT_LOG_CAPACITY : static_cast<size_t>(logCapacity));
+        }
+        if (batchFile.empty()) {
+            simulation.start();
+        } else {
+            simulation.startBatch(batchFile);
+        }
+    } catch (const std::exception &e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
     if(backup!=nullptr){
     	delete backup;
     	backup = nullptr;
     }
     return 0;
 }
-